@@ -0,0 +1,293 @@
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include "carver.hpp"
+#include "image_gen.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "searcher.hpp"
+
+/* --- Helper --- */
+
+namespace {
+
+struct BenchOptions {
+    GenConfig gen;
+    std::string workDir;          // Empty = fresh directory under /tmp
+    bool keep = false;            // Keep image and outputs after the run
+    CarverOptions carver;
+    double minRecall = 0.0;       // Regression gates (0 = not checked)
+    double minPrecision = 0.0;
+    double minCarveGBps = 0.0;
+    double minSearchGBps = 0.0;
+};
+
+struct TypeScore {
+    uint64_t truth = 0;
+    uint64_t recovered = 0;
+};
+
+double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool writeAll(const std::string& path, const std::vector<uint8_t>& data) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    size_t total = 0;
+    while (total < data.size()) {
+        ssize_t n = write(fd, data.data() + total, data.size() - total);
+        if (n <= 0) break;
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+    return total == data.size();
+}
+
+bool readAll(const std::string& path, std::vector<uint8_t>& data) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    fstat(fd, &st);
+    data.resize(static_cast<size_t>(st.st_size));
+    size_t total = 0;
+    while (total < data.size()) {
+        ssize_t n = read(fd, data.data() + total, data.size() - total);
+        if (n <= 0) break;
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+    data.resize(total);
+    return true;
+}
+
+void removeTree(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") continue;
+            std::string child = path + "/" + name;
+            struct stat st;
+            if (lstat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) removeTree(child);
+            else unlink(child.c_str());
+        }
+        closedir(dir);
+    }
+    rmdir(path.c_str());
+}
+
+// Searcher throughput over the in-memory image for every signature header
+double benchSearcher(const std::vector<uint8_t>& image, const std::vector<FileSignature>& signatures) {
+    const size_t chunkSize = 1024 * 1024;
+    std::vector<uint8_t> chunk;
+    std::vector<Searcher::Pattern> patterns;
+    for (const auto& sig : signatures) patterns.push_back(Searcher::compile(sig.header));
+    double seconds = 0.0;
+    uint64_t bytes = 0;
+
+    for (size_t pos = 0; pos < image.size(); pos += chunkSize) {
+        size_t len = std::min(chunkSize, image.size() - pos);
+        chunk.assign(image.begin() + pos, image.begin() + pos + len);
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& pattern : patterns) {
+            int64_t idx = 0;
+            while ((idx = Searcher::search(chunk, pattern, static_cast<size_t>(idx))) != -1) ++idx;
+            bytes += len;
+        }
+        seconds += elapsedSeconds(start);
+    }
+    return seconds > 0 ? bytes / seconds / 1e9 : 0.0;
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]" << std::endl;
+    std::cout << "Image options:" << std::endl;
+    std::cout << "  --size-mb=N             Image size in MiB (default: 64)" << std::endl;
+    std::cout << "  --seed=N                Random seed (default: 1)" << std::endl;
+    std::cout << "  --fragment-rate=F       Fraction of JPG/PDF files split in two (default: 0.1)" << std::endl;
+    std::cout << "  --thumbnail-rate=F      Fraction of JPGs with an EXIF thumbnail (default: 0.2)" << std::endl;
+    std::cout << "Run options:" << std::endl;
+    std::cout << "  --workdir=DIR           Where to place the image and outputs (default: new dir in /tmp)" << std::endl;
+    std::cout << "  --keep                  Keep the image, ground truth and outputs" << std::endl;
+    std::cout << "  --validate=off|tag|discard" << std::endl;
+    std::cout << "Regression gates (exit 1 when missed):" << std::endl;
+    std::cout << "  --min-recall=F --min-precision=F --min-carve-gbps=F --min-search-gbps=F" << std::endl;
+}
+
+bool parseArgs(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) { return arg.substr(strlen(prefix)); };
+        if (arg.rfind("--size-mb=", 0) == 0) options.gen.imageSize = std::stoull(value("--size-mb=")) << 20;
+        else if (arg.rfind("--seed=", 0) == 0) options.gen.seed = std::stoull(value("--seed="));
+        else if (arg.rfind("--fragment-rate=", 0) == 0) options.gen.fragmentRate = std::stod(value("--fragment-rate="));
+        else if (arg.rfind("--thumbnail-rate=", 0) == 0) options.gen.thumbnailRate = std::stod(value("--thumbnail-rate="));
+        else if (arg.rfind("--workdir=", 0) == 0) options.workDir = value("--workdir=");
+        else if (arg == "--keep") options.keep = true;
+        else if (arg.rfind("--validate=", 0) == 0) {
+            std::string mode = value("--validate=");
+            if (mode == "off") options.carver.validation = ValidationMode::Off;
+            else if (mode == "tag") options.carver.validation = ValidationMode::Tag;
+            else if (mode == "discard") options.carver.validation = ValidationMode::Discard;
+            else return false;
+        }
+        else if (arg.rfind("--min-recall=", 0) == 0) options.minRecall = std::stod(value("--min-recall="));
+        else if (arg.rfind("--min-precision=", 0) == 0) options.minPrecision = std::stod(value("--min-precision="));
+        else if (arg.rfind("--min-carve-gbps=", 0) == 0) options.minCarveGBps = std::stod(value("--min-carve-gbps="));
+        else if (arg.rfind("--min-search-gbps=", 0) == 0) options.minSearchGBps = std::stod(value("--min-search-gbps="));
+        else return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // 1. Work directory
+    // Only a directory created here is removed whole; in an existing --workdir just our own files go
+    std::string workDir = options.workDir;
+    bool ownWorkDir = true;
+    if (workDir.empty()) {
+        char templ[] = "/tmp/fileedo-bench-XXXXXX";
+        if (!mkdtemp(templ)) {
+            perror("Error creating work directory");
+            return 1;
+        }
+        workDir = templ;
+    } else {
+        ownWorkDir = mkdir(workDir.c_str(), 0755) == 0;
+    }
+    const std::string imagePath = workDir + "/bench.img";
+    const std::string outDir = workDir + "/out";
+    mkdir(outDir.c_str(), 0755);
+
+    // 2. Deterministic image + ground truth
+    auto genStart = std::chrono::steady_clock::now();
+    ImageGenerator generator(options.gen);
+    std::vector<uint8_t> image;
+    std::vector<PlantedFile> planted = generator.generate(image);
+    if (!writeAll(imagePath, image) || !ImageGenerator::writeTruth(imagePath + ".truth.csv", planted)) {
+        std::cerr << "Error: Failed to write benchmark image to " << workDir << std::endl;
+        return 1;
+    }
+    std::cout << "[*] Generated " << (image.size() >> 20) << " MiB image with " << planted.size()
+              << " files in " << std::fixed << std::setprecision(2) << elapsedSeconds(genStart) << " s" << std::endl;
+
+    // 3. Searcher throughput
+    std::vector<FileSignature> signatures = SignatureDB::getSignatures();
+    double searchGBps = benchSearcher(image, signatures);
+
+    // 4. Full carve, outputs written into outDir
+    Logger::setLevel(LogLevel::Quiet);
+    Metrics::instance().reset();
+    options.carver.checkpointInterval = 0;
+    options.carver.outputDir = outDir;
+
+    auto carveStart = std::chrono::steady_clock::now();
+    {
+        FileCarver carver(imagePath, options.carver);
+        if (!carver.initialize()) return 1;
+        carver.startCarving();
+    }
+    double carveSeconds = elapsedSeconds(carveStart);
+    double carveGBps = carveSeconds > 0 ? image.size() / carveSeconds / 1e9 : 0.0;
+
+    // 5. Score outputs against the ground truth: a hit is an output at the right offset with identical bytes
+    std::map<std::pair<uint64_t, std::string>, uint64_t> truthHash;
+    std::map<std::string, TypeScore> perType;
+    for (const auto& sig : signatures) perType[sig.extension];
+    uint64_t truthCount = 0;
+    for (const auto& file : planted) {
+        auto it = perType.find(file.type);
+        if (it == perType.end()) continue; // No signature for this type (e.g. zip): a distractor only
+        it->second.truth++;
+        truthCount++;
+        truthHash[{file.offset, file.type}] = file.hash;
+    }
+
+    uint64_t outputs = 0;
+    uint64_t truePositives = 0;
+    DIR* dir = opendir(outDir.c_str());
+    while (dir) {
+        dirent* entry = readdir(dir);
+        if (!entry) break;
+        std::string name = entry->d_name;
+        uint64_t offset;
+        char ext[16];
+        if (sscanf(name.c_str(), "recovered_%" SCNu64 ".%15s", &offset, ext) != 2) continue;
+        std::string type = ext;
+        if (type.find('.') != std::string::npos) continue; // Tagged as invalid
+        outputs++;
+
+        auto truth = truthHash.find({offset, type});
+        if (truth == truthHash.end()) continue;
+        std::vector<uint8_t> data;
+        if (readAll(outDir + "/" + name, data) && ImageGenerator::hash(data.data(), data.size()) == truth->second) {
+            truePositives++;
+            perType[type].recovered++;
+        }
+    }
+    if (dir) closedir(dir);
+
+    double precision = outputs ? static_cast<double>(truePositives) / outputs : 1.0;
+    double recall = truthCount ? static_cast<double>(truePositives) / truthCount : 1.0;
+
+    // 6. Report
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "[*] Searcher: " << searchGBps << " GB/s per pattern" << std::endl;
+    std::cout << "[*] Carve: " << carveGBps << " GB/s (" << carveSeconds << " s)" << std::endl;
+    std::cout << "[*] Precision " << precision << " (" << truePositives << "/" << outputs << "), recall "
+              << recall << " (" << truePositives << "/" << truthCount << ")" << std::endl;
+    for (const auto& entry : perType) {
+        std::cout << "    " << entry.first << ": " << entry.second.recovered << "/" << entry.second.truth << std::endl;
+    }
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+    json << "{\"image_bytes\":" << image.size() << ",\"seed\":" << options.gen.seed
+         << ",\"search_gbps\":" << searchGBps << ",\"carve_gbps\":" << carveGBps
+         << ",\"precision\":" << precision << ",\"recall\":" << recall
+         << ",\"true_positives\":" << truePositives << ",\"outputs\":" << outputs
+         << ",\"truth\":" << truthCount << "}";
+    std::cout << json.str() << std::endl;
+
+    if (!options.keep && ownWorkDir) {
+        removeTree(workDir);
+    } else if (!options.keep) {
+        unlink(imagePath.c_str());
+        unlink((imagePath + ".truth.csv").c_str());
+        removeTree(outDir);
+    } else std::cout << "[*] Kept image and outputs in " << workDir << std::endl;
+
+    // 7. Regression gates
+    bool pass = true;
+    auto gate = [&pass](const char* name, double value, double minimum) {
+        if (minimum > 0 && value < minimum) {
+            std::cout << "[FAIL] " << name << " " << value << " < " << minimum << std::endl;
+            pass = false;
+        }
+    };
+    gate("recall", recall, options.minRecall);
+    gate("precision", precision, options.minPrecision);
+    gate("carve GB/s", carveGBps, options.minCarveGBps);
+    gate("search GB/s", searchGBps, options.minSearchGBps);
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tolerant_source.hpp"
+
+/* --- Helper --- */
+
+namespace {
+
+const uint32_t SECTOR = 512;
+const size_t GUARD = 4096;          // Canary bytes on both sides of every read buffer
+const uint8_t CANARY = 0xA5;
+
+// In-memory image that fails reads touching a set of bad ranges, like a damaged disk.
+// With shortReads a read starting before a bad range returns the bytes up to it (as pread does
+// when the device errors mid-request); otherwise the whole request fails.
+class FaultyImageSource : public ImageSource {
+public:
+    FaultyImageSource(std::vector<uint8_t> data, std::vector<BadSectorMap::Range> bad, bool shortReads)
+        : data_(std::move(data)), bad_(std::move(bad)), shortReads_(shortReads) {}
+
+    ssize_t readAt(uint64_t offset, void* buffer, size_t size) override {
+        if (offset >= data_.size()) return 0;
+        uint64_t length = std::min<uint64_t>(size, data_.size() - offset);
+        for (const auto& range : bad_) {
+            if (offset >= range.offset + range.length || offset + length <= range.offset) continue;
+            if (!shortReads_ || offset >= range.offset) return -1;
+            length = range.offset - offset;
+        }
+        memcpy(buffer, data_.data() + offset, length);
+        return static_cast<ssize_t>(length);
+    }
+    uint64_t size() const override { return data_.size(); }
+    std::string describe() const override { return "faulty image"; }
+
+    // Unreadable bytes inside [from, to)
+    uint64_t badBytes(uint64_t from, uint64_t to) const {
+        uint64_t total = 0;
+        for (const auto& range : bad_) {
+            uint64_t start = std::max(from, range.offset);
+            uint64_t end = std::min(to, range.offset + range.length);
+            if (end > start) total += end - start;
+        }
+        return total;
+    }
+    const std::vector<uint8_t>& data() const { return data_; }
+
+private:
+    std::vector<uint8_t> data_;
+    std::vector<BadSectorMap::Range> bad_;
+    bool shortReads_;
+};
+
+struct Scenario {
+    const char* name;
+    bool shortReads;
+    uint64_t start;     // First read offset (unaligned values exercise partial sectors)
+    uint64_t stride;    // Distance between sequential reads
+    size_t length;      // Bytes per read
+};
+
+// Read one window through the tolerant source and check it byte by byte
+bool checkRead(TolerantImageSource& source, const FaultyImageSource& image, uint64_t offset, size_t length,
+               std::string& error) {
+    std::vector<uint8_t> buffer(GUARD + length + GUARD, CANARY);
+    uint8_t* out = buffer.data() + GUARD;
+    ssize_t n = source.readAt(offset, out, length);
+    uint64_t expected = offset >= image.size() ? 0 : std::min<uint64_t>(length, image.size() - offset);
+    if (n != static_cast<ssize_t>(expected)) {
+        error = "read at " + std::to_string(offset) + " returned " + std::to_string(n);
+        return false;
+    }
+    for (size_t i = 0; i < GUARD; ++i) {
+        if (buffer[i] != CANARY || buffer[GUARD + length + i] != CANARY) {
+            error = "read at " + std::to_string(offset) + " wrote outside its buffer";
+            return false;
+        }
+    }
+    // Walk the window in runs that are either inside or outside the map. The snapshot is taken after
+    // the read and the map only grows, so it covers everything the read zero-filled.
+    const std::vector<BadSectorMap::Range> ranges = source.badSectors().ranges();
+    const uint8_t* truth = image.data().data();
+    uint64_t pos = offset;
+    const uint64_t stop = offset + expected;
+    while (pos < stop) {
+        auto it = std::find_if(ranges.begin(), ranges.end(),
+                               [pos](const BadSectorMap::Range& r) { return r.offset + r.length > pos; });
+        if (it != ranges.end() && it->offset <= pos) {
+            // Marked: zero-filled, or intact if another reader marked it after this read returned it
+            uint64_t to = std::min(stop, it->offset + it->length);
+            for (; pos < to; ++pos) {
+                uint8_t byte = out[pos - offset];
+                if (byte != 0 && byte != truth[pos]) {
+                    error = "wrong byte at " + std::to_string(pos) + " in a marked range";
+                    return false;
+                }
+            }
+            continue;
+        }
+        uint64_t to = it == ranges.end() ? stop : std::min(stop, it->offset);
+        if (image.badBytes(pos, to) > 0) {
+            error = "unreadable bytes in " + std::to_string(pos) + "-" + std::to_string(to) + " missing from the bad sector map";
+            return false;
+        }
+        if (memcmp(out + (pos - offset), truth + pos, to - pos) != 0) {
+            error = "wrong data in " + std::to_string(pos) + "-" + std::to_string(to);
+            return false;
+        }
+        pos = to;
+    }
+    return true;
+}
+
+// Bytes recorded as bad although they were readable (skipped over instead of trimmed back)
+uint64_t overMarked(TolerantImageSource& source, const FaultyImageSource& image) {
+    uint64_t total = 0;
+    for (const auto& range : source.badSectors().ranges()) {
+        total += range.length - image.badBytes(range.offset, range.offset + range.length);
+    }
+    return total;
+}
+
+bool runScenario(const Scenario& scenario, const std::vector<uint8_t>& data,
+                 const std::vector<BadSectorMap::Range>& bad, uint64_t maxSkip, uint64_t seed) {
+    auto image = std::make_shared<FaultyImageSource>(data, bad, scenario.shortReads);
+    TolerantImageSource source(image, SECTOR, maxSkip);
+    std::string error;
+    bool ok = true;
+
+    // 1. Sequential scan
+    for (uint64_t offset = scenario.start; ok && offset < data.size(); offset += scenario.stride) {
+        ok = checkRead(source, *image, offset, scenario.length, error);
+    }
+
+    // 2. On a fresh source: random windows, each right after a read that ended inside a damaged area
+    //    (the skip state it leaves behind must not leak into an unrelated read)
+    TolerantImageSource fresh(image, SECTOR, maxSkip);
+    std::mt19937_64 rng(seed);
+    for (int i = 0; ok && i < 2000; ++i) {
+        const auto& range = bad[rng() % bad.size()];
+        uint64_t into = range.offset + rng() % range.length;
+        ok = checkRead(fresh, *image, into - std::min<uint64_t>(into, rng() % 8192), 1 + rng() % 8192, error);
+        const auto& other = bad[rng() % bad.size()];
+        uint64_t offset = other.offset - std::min<uint64_t>(other.offset, rng() % 4096);
+        if (ok) ok = checkRead(fresh, *image, offset, 1 + rng() % 65536, error);
+    }
+
+    // 3. Concurrent readers sharing one source (scan, gap carver and validation do the same)
+    auto shared = std::make_shared<TolerantImageSource>(image, SECTOR, maxSkip);
+    std::atomic<bool> concurrentOk{true};
+    std::vector<std::thread> readers;
+    for (uint64_t t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t] {
+            std::mt19937_64 local(seed + t + 1);
+            std::string localError;
+            for (int i = 0; i < 500 && concurrentOk; ++i) {
+                uint64_t offset = local() % data.size();
+                if (!checkRead(*shared, *image, offset, 1 + local() % 65536, localError)) {
+                    concurrentOk = false;
+                    std::cout << "[FAIL] " << scenario.name << " (concurrent): " << localError << std::endl;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+
+    if (!ok) std::cout << "[FAIL] " << scenario.name << ": " << error << std::endl;
+    if (!ok || !concurrentOk) return false;
+    std::cout << "[*] " << scenario.name << ": ok (" << source.badSectors().badBytes() << " bytes marked, "
+              << overMarked(source, *image) << " readable bytes skipped)" << std::endl;
+    return true;
+}
+
+// The map must survive a save / load round trip unchanged
+bool checkMapRoundTrip(const std::vector<BadSectorMap::Range>& bad) {
+    char path[] = "/tmp/fileedo-faultcheck-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("Error creating temporary file");
+        return false;
+    }
+    close(fd);
+
+    BadSectorMap saved;
+    for (const auto& range : bad) saved.add(range.offset, range.length);
+    BadSectorMap loaded;
+    bool ok = saved.save(path) && loaded.load(path) && loaded.badBytes() == saved.badBytes() &&
+              loaded.ranges().size() == saved.ranges().size();
+    unlink(path);
+    std::cout << (ok ? "[*] Bad sector map round trip: ok" : "[FAIL] Bad sector map round trip") << std::endl;
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--seed=", 0) == 0) {
+            seed = std::strtoull(arg.c_str() + strlen("--seed="), nullptr, 0);
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--seed=N]" << std::endl;
+            std::cout << "Reads a damaged in-memory image through TolerantImageSource; exit code 1 on any error" << std::endl;
+            return 1;
+        }
+    }
+
+    // 8 MiB of noise with a lone bad sector, a short run, a long run wider than the skip cap,
+    // two runs close enough to be jumped over together, and a damaged last sector
+    std::vector<uint8_t> data(8 << 20);
+    std::mt19937_64 rng(seed);
+    for (auto& byte : data) byte = static_cast<uint8_t>(rng() | 1);   // Never 0, so zero-fill is visible
+    const uint64_t maxSkip = 64 * 1024;
+    std::vector<BadSectorMap::Range> bad = {
+        {1000 * SECTOR, SECTOR},
+        {3000 * SECTOR, 7 * SECTOR},
+        {2ULL << 20, 1ULL << 20},
+        {5ULL << 20, 16 * SECTOR},
+        {(5ULL << 20) + 40 * SECTOR, 8 * SECTOR},
+        {data.size() - SECTOR, SECTOR},
+    };
+
+    const Scenario scenarios[] = {
+        {"Aligned reads, failing requests", false, 0, 65536, 65536},
+        {"Aligned reads, short reads", true, 0, 65536, 65536},
+        {"Unaligned reads, failing requests", false, 100, 65536 - 37, 65536},
+        {"Unaligned reads, short reads", true, 100, 65536 - 37, 65536},
+        {"Small unaligned reads, short reads", true, 7, 1000, 1000},
+    };
+
+    bool pass = true;
+    for (const auto& scenario : scenarios) pass = runScenario(scenario, data, bad, maxSkip, seed) && pass;
+    pass = checkMapRoundTrip(bad) && pass;
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,454 @@
+#include "image_gen.hpp"
+#include "checksum.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+/* --- Helper --- */
+
+namespace {
+
+void putBE16(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<uint8_t>(v >> shift));
+}
+
+void putLE16(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void putLE32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int shift = 0; shift <= 24; shift += 8) out.push_back(static_cast<uint8_t>(v >> shift));
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& s) {
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+// ITU T.81 Annex K standard luminance tables
+const uint8_t DC_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const uint8_t DC_VALS[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+const uint8_t AC_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D};
+const uint8_t AC_VALS[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+    0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+    0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+    0xF9, 0xFA};
+
+struct HuffCode {
+    uint16_t code = 0;
+    uint8_t length = 0;
+};
+
+void buildCodes(const uint8_t* bits, const uint8_t* vals, HuffCode* codes) {
+    uint16_t code = 0;
+    size_t k = 0;
+    for (int len = 1; len <= 16; ++len) {
+        for (int i = 0; i < bits[len - 1]; ++i) codes[vals[k++]] = {code++, static_cast<uint8_t>(len)};
+        code <<= 1;
+    }
+}
+
+// MSB-first bit writer with JPEG byte stuffing
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void put(uint32_t value, int length) {
+        for (int i = length - 1; i >= 0; --i) {
+            acc_ = (acc_ << 1) | ((value >> i) & 1);
+            if (++bits_ == 8) emit();
+        }
+    }
+
+    void flush() {
+        while (bits_ != 0) put(1, 1); // Pad with 1 bits
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint32_t acc_ = 0;
+    int bits_ = 0;
+
+    void emit() {
+        uint8_t byte = static_cast<uint8_t>(acc_);
+        out_.push_back(byte);
+        if (byte == 0xFF) out_.push_back(0x00);
+        acc_ = 0;
+        bits_ = 0;
+    }
+};
+
+void putSegment(std::vector<uint8_t>& out, uint8_t marker, const std::vector<uint8_t>& payload) {
+    out.push_back(0xFF);
+    out.push_back(marker);
+    putBE16(out, static_cast<uint32_t>(payload.size() + 2));
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+} // namespace
+
+/* --- Method of ImageGenerator --- */
+
+ImageGenerator::ImageGenerator(const GenConfig& config) : config_(config), rng_(config.seed) {}
+
+uint64_t ImageGenerator::nextRange(uint64_t lo, uint64_t hi) {
+    if (hi <= lo) return lo;
+    return lo + rng_() % (hi - lo + 1);
+}
+
+bool ImageGenerator::chance(double probability) {
+    return (rng_() >> 11) * (1.0 / 9007199254740992.0) < probability;
+}
+
+uint64_t ImageGenerator::hash(const uint8_t* data, size_t size) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+std::vector<uint8_t> ImageGenerator::makeJpeg(uint32_t width, uint32_t height, bool withThumbnail) {
+    HuffCode dcCodes[256];
+    HuffCode acCodes[256];
+    buildCodes(DC_BITS, DC_VALS, dcCodes);
+    buildCodes(AC_BITS, AC_VALS, acCodes);
+
+    std::vector<uint8_t> out = {0xFF, 0xD8};
+    std::vector<uint8_t> seg;
+
+    // APP0 JFIF
+    seg = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    putSegment(out, 0xE0, seg);
+
+    // APP1 Exif with an embedded thumbnail (a complete JPEG, including its own FFD9)
+    if (withThumbnail) {
+        seg = {'E', 'x', 'i', 'f', 0, 0};
+        std::vector<uint8_t> thumb = makeJpeg(16, 16, false);
+        seg.insert(seg.end(), thumb.begin(), thumb.end());
+        putSegment(out, 0xE1, seg);
+    }
+
+    // DQT
+    seg.assign(1, 0x00);
+    for (int i = 0; i < 64; ++i) seg.push_back(static_cast<uint8_t>(nextRange(1, 32)));
+    putSegment(out, 0xDB, seg);
+
+    // SOF0, three components, no subsampling
+    seg.clear();
+    seg.push_back(8);
+    putBE16(seg, height);
+    putBE16(seg, width);
+    seg.push_back(3);
+    for (uint8_t c = 1; c <= 3; ++c) {
+        seg.push_back(c);
+        seg.push_back(0x11);
+        seg.push_back(0);
+    }
+    putSegment(out, 0xC0, seg);
+
+    // DHT: one DC and one AC table shared by all components
+    seg.assign(1, 0x00);
+    seg.insert(seg.end(), DC_BITS, DC_BITS + 16);
+    seg.insert(seg.end(), DC_VALS, DC_VALS + sizeof(DC_VALS));
+    putSegment(out, 0xC4, seg);
+    seg.assign(1, 0x10);
+    seg.insert(seg.end(), AC_BITS, AC_BITS + 16);
+    seg.insert(seg.end(), AC_VALS, AC_VALS + sizeof(AC_VALS));
+    putSegment(out, 0xC4, seg);
+
+    // SOS
+    seg = {3, 1, 0x00, 2, 0x00, 3, 0x00, 0, 63, 0};
+    putSegment(out, 0xDA, seg);
+
+    // Entropy-coded data: random but valid coefficients
+    BitWriter writer(out);
+    uint64_t blocks = static_cast<uint64_t>((width + 7) / 8) * ((height + 7) / 8) * 3;
+    for (uint64_t b = 0; b < blocks; ++b) {
+        int32_t diff = static_cast<int32_t>(nextRange(0, 400)) - 200;
+        uint32_t magnitude = static_cast<uint32_t>(diff < 0 ? -diff : diff);
+        int size = 0;
+        while (magnitude >> size) ++size;
+        writer.put(dcCodes[size].code, dcCodes[size].length);
+        if (size) writer.put(diff > 0 ? diff : diff + (1 << size) - 1, size);
+
+        int k = 1;
+        int coefficients = static_cast<int>(nextRange(0, 6));
+        for (int i = 0; i < coefficients && k < 63; ++i) {
+            int run = static_cast<int>(nextRange(0, 3));
+            if (k + run > 63) break;
+            int value = static_cast<int>(nextRange(1, 60));
+            int acSize = 0;
+            while (value >> acSize) ++acSize;
+            uint8_t symbol = static_cast<uint8_t>((run << 4) | acSize);
+            writer.put(acCodes[symbol].code, acCodes[symbol].length);
+            writer.put(value, acSize);
+            k += run + 1;
+        }
+        if (k <= 63) writer.put(acCodes[0x00].code, acCodes[0x00].length); // EOB
+    }
+    writer.flush();
+
+    out.push_back(0xFF);
+    out.push_back(0xD9);
+    return out;
+}
+
+std::vector<uint8_t> ImageGenerator::makePng(uint32_t width, uint32_t height) {
+    std::vector<uint8_t> out = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+
+    auto putChunk = [&out](const char* type, const std::vector<uint8_t>& data) {
+        putBE32(out, static_cast<uint32_t>(data.size()));
+        size_t start = out.size();
+        putString(out, type);
+        out.insert(out.end(), data.begin(), data.end());
+        putBE32(out, Checksum::crc32(out.data() + start, out.size() - start));
+    };
+
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, width);
+    putBE32(ihdr, height);
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0}); // 8-bit RGB
+    putChunk("IHDR", ihdr);
+
+    // Raw scanlines (filter byte 0 + RGB), stored in uncompressed deflate blocks
+    std::vector<uint8_t> raw;
+    for (uint32_t y = 0; y < height; ++y) {
+        raw.push_back(0);
+        for (uint32_t x = 0; x < width * 3; ++x) raw.push_back(static_cast<uint8_t>(rng_()));
+    }
+
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size() || pos == 0; ) {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        bool last = pos + len >= raw.size();
+        zlib.push_back(last ? 1 : 0);
+        putLE16(zlib, static_cast<uint32_t>(len));
+        putLE16(zlib, static_cast<uint32_t>(~len & 0xFFFF));
+        zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+        if (last) break;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBE32(zlib, (b << 16) | a);
+
+    // Split IDAT like real encoders do
+    for (size_t pos = 0; pos < zlib.size(); pos += 32768) {
+        size_t len = std::min<size_t>(32768, zlib.size() - pos);
+        putChunk("IDAT", std::vector<uint8_t>(zlib.begin() + pos, zlib.begin() + pos + len));
+    }
+    putChunk("IEND", {});
+    return out;
+}
+
+std::vector<uint8_t> ImageGenerator::makePdf(size_t objectCount, size_t streamBytes) {
+    std::vector<uint8_t> out;
+    putString(out, "%PDF-1.4\n");
+    std::vector<size_t> offsets;
+
+    const size_t pages = std::max<size_t>(1, objectCount);
+    offsets.push_back(out.size());
+    putString(out, "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n");
+    offsets.push_back(out.size());
+    std::string kids;
+    for (size_t p = 0; p < pages; ++p) kids += std::to_string(3 + p * 2) + " 0 R ";
+    putString(out, "2 0 obj\n<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(pages) + " >>\nendobj\n");
+
+    for (size_t p = 0; p < pages; ++p) {
+        size_t pageObj = 3 + p * 2;
+        offsets.push_back(out.size());
+        putString(out, std::to_string(pageObj) + " 0 obj\n<< /Type /Page /Parent 2 0 R /Contents " +
+                       std::to_string(pageObj + 1) + " 0 R >>\nendobj\n");
+        offsets.push_back(out.size());
+        putString(out, std::to_string(pageObj + 1) + " 0 obj\n<< /Length " + std::to_string(streamBytes) +
+                       " >>\nstream\n");
+        for (size_t i = 0; i < streamBytes; ++i) out.push_back(static_cast<uint8_t>('a' + rng_() % 26));
+        putString(out, "\nendstream\nendobj\n");
+    }
+
+    size_t xref = out.size();
+    putString(out, "xref\n0 " + std::to_string(offsets.size() + 1) + "\n0000000000 65535 f \n");
+    for (size_t off : offsets) {
+        char entry[21];
+        snprintf(entry, sizeof(entry), "%010zu 00000 n \n", off);
+        putString(out, entry);
+    }
+    putString(out, "trailer\n<< /Size " + std::to_string(offsets.size() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+                   std::to_string(xref) + "\n%%EOF");
+    return out;
+}
+
+std::vector<uint8_t> ImageGenerator::makeZip(size_t entryCount, size_t entryBytes) {
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> central;
+
+    for (size_t e = 0; e < entryCount; ++e) {
+        std::string name = "file" + std::to_string(e) + ".txt";
+        std::vector<uint8_t> data(entryBytes);
+        for (auto& byte : data) byte = static_cast<uint8_t>('A' + rng_() % 26);
+        uint32_t crc = Checksum::crc32(data.data(), data.size());
+        uint32_t localOffset = static_cast<uint32_t>(out.size());
+
+        putLE32(out, 0x04034B50);
+        putLE16(out, 20);
+        putLE16(out, 0);
+        putLE16(out, 0); // Stored
+        putLE16(out, 0);
+        putLE16(out, 0x21);
+        putLE32(out, crc);
+        putLE32(out, static_cast<uint32_t>(data.size()));
+        putLE32(out, static_cast<uint32_t>(data.size()));
+        putLE16(out, static_cast<uint32_t>(name.size()));
+        putLE16(out, 0);
+        putString(out, name);
+        out.insert(out.end(), data.begin(), data.end());
+
+        putLE32(central, 0x02014B50);
+        putLE16(central, 20);
+        putLE16(central, 20);
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE16(central, 0x21);
+        putLE32(central, crc);
+        putLE32(central, static_cast<uint32_t>(data.size()));
+        putLE32(central, static_cast<uint32_t>(data.size()));
+        putLE16(central, static_cast<uint32_t>(name.size()));
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE16(central, 0);
+        putLE32(central, 0);
+        putLE32(central, localOffset);
+        putString(central, name);
+    }
+
+    uint32_t centralOffset = static_cast<uint32_t>(out.size());
+    out.insert(out.end(), central.begin(), central.end());
+    putLE32(out, 0x06054B50);
+    putLE16(out, 0);
+    putLE16(out, 0);
+    putLE16(out, static_cast<uint32_t>(entryCount));
+    putLE16(out, static_cast<uint32_t>(entryCount));
+    putLE32(out, static_cast<uint32_t>(central.size()));
+    putLE32(out, centralOffset);
+    putLE16(out, 0);
+    return out;
+}
+
+std::vector<uint8_t> ImageGenerator::makeFile(const std::string& type, bool& hasThumbnail) {
+    hasThumbnail = false;
+    if (type == "jpg") {
+        hasThumbnail = chance(config_.thumbnailRate);
+        uint32_t side = static_cast<uint32_t>(nextRange(4, 64)) * 8;
+        return makeJpeg(side, static_cast<uint32_t>(nextRange(4, 64)) * 8, hasThumbnail);
+    }
+    if (type == "png") return makePng(static_cast<uint32_t>(nextRange(16, 256)), static_cast<uint32_t>(nextRange(16, 256)));
+    if (type == "pdf") return makePdf(nextRange(1, 8), nextRange(512, 32768));
+    return makeZip(nextRange(1, 8), nextRange(256, 16384));
+}
+
+void ImageGenerator::fillFree(uint8_t* data, size_t size) {
+    if (chance(config_.zeroRatio)) {
+        std::memset(data, 0, size);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t value = rng_();
+        std::memcpy(data + i, &value, 8);
+    }
+    for (; i < size; ++i) data[i] = static_cast<uint8_t>(rng_());
+}
+
+std::vector<PlantedFile> ImageGenerator::generate(std::vector<uint8_t>& image) {
+    const uint64_t cluster = config_.clusterSize;
+    const uint64_t totalClusters = config_.imageSize / cluster;
+    image.assign(config_.imageSize, 0);
+
+    std::vector<PlantedFile> planted;
+    uint64_t cursor = 0;         // Next free cluster
+    uint64_t plantedBytes = 0;
+    const uint64_t target = static_cast<uint64_t>(config_.imageSize * config_.fillRatio);
+
+    auto fillClusters = [&](uint64_t first, uint64_t count) {
+        if (count) fillFree(image.data() + first * cluster, count * cluster);
+    };
+
+    while (plantedBytes < target && !config_.types.empty()) {
+        const std::string& type = config_.types[rng_() % config_.types.size()];
+        PlantedFile file;
+        file.type = type;
+        std::vector<uint8_t> data = makeFile(type, file.hasThumbnail);
+        file.size = data.size();
+        file.hash = hash(data.data(), data.size());
+
+        uint64_t fileClusters = (data.size() + cluster - 1) / cluster;
+        uint64_t leadGap = nextRange(0, 16);
+        bool fragmented = (type == "jpg" || type == "pdf") && fileClusters >= 3 && chance(config_.fragmentRate);
+        uint64_t splitClusters = fragmented ? nextRange(1, fileClusters - 1) : fileClusters;
+        uint64_t holeClusters = fragmented ? nextRange(1, 8) : 0;
+
+        if (cursor + leadGap + fileClusters + holeClusters > totalClusters) break;
+
+        // Free space before the file, then the file itself (with slack at the end of its last cluster)
+        fillClusters(cursor, leadGap);
+        cursor += leadGap;
+        uint64_t start = cursor * cluster;
+        fillClusters(cursor, fileClusters + holeClusters);
+
+        uint64_t firstLen = std::min<uint64_t>(splitClusters * cluster, data.size());
+        std::memcpy(image.data() + start, data.data(), firstLen);
+        file.offset = start;
+        file.fragments.push_back({start, firstLen});
+        if (firstLen < data.size()) {
+            uint64_t second = start + (splitClusters + holeClusters) * cluster;
+            std::memcpy(image.data() + second, data.data() + firstLen, data.size() - firstLen);
+            file.fragments.push_back({second, data.size() - firstLen});
+        }
+
+        cursor += fileClusters + holeClusters;
+        plantedBytes += data.size();
+        planted.push_back(file);
+    }
+
+    // Free space up to the end of the image
+    fillClusters(cursor, totalClusters - cursor);
+    uint64_t tail = totalClusters * cluster;
+    if (tail < image.size()) fillFree(image.data() + tail, image.size() - tail);
+    return planted;
+}
+
+bool ImageGenerator::writeTruth(const std::string& path, const std::vector<PlantedFile>& files) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    out << "type,offset,size,hash,fragments,thumbnail\n";
+    for (const auto& file : files) {
+        out << file.type << ',' << file.offset << ',' << file.size << ',' << std::hex << file.hash << std::dec << ',';
+        for (size_t i = 0; i < file.fragments.size(); ++i) {
+            if (i) out << ';';
+            out << file.fragments[i].offset << ':' << file.fragments[i].length;
+        }
+        out << ',' << (file.hasThumbnail ? 1 : 0) << '\n';
+    }
+    return out.good();
+}
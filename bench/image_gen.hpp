@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Parameters of a synthetic disk image
+struct GenConfig {
+    uint64_t imageSize = 64ULL * 1024 * 1024;   // Total image size in bytes
+    uint64_t seed = 1;                          // Same seed -> byte-identical image
+    uint32_t clusterSize = 4096;                // Files start on cluster boundaries
+    double fillRatio = 0.5;                     // Fraction of the image occupied by planted files
+    double fragmentRate = 0.1;                  // Fraction of JPG/PDF files split in two fragments
+    double thumbnailRate = 0.2;                 // Fraction of JPGs carrying an EXIF thumbnail
+    double zeroRatio = 0.3;                     // Fraction of free space that is zero-filled instead of noise
+    std::vector<std::string> types = {"jpg", "png", "pdf", "zip"};
+};
+
+// Byte range of a planted file inside the image
+struct Fragment {
+    uint64_t offset;
+    uint64_t length;
+};
+
+// Ground truth for one planted file
+struct PlantedFile {
+    std::string type;
+    uint64_t offset = 0;                  // Image offset of the first byte
+    uint64_t size = 0;                    // File size
+    uint64_t hash = 0;                    // FNV-1a 64 of the file contents
+    bool hasThumbnail = false;
+    std::vector<Fragment> fragments;      // One entry unless fragmented
+};
+
+// Deterministic synthetic disk image builder with structurally valid JPG/PNG/PDF/ZIP files
+class ImageGenerator {
+public:
+    explicit ImageGenerator(const GenConfig& config);
+
+    /**
+     * @brief Build the image in memory
+     * @param image: Receives config.imageSize bytes
+     * @return: Ground truth of every planted file, ordered by offset
+     */
+    std::vector<PlantedFile> generate(std::vector<uint8_t>& image);
+
+    /**
+     * @brief Write the ground truth as CSV (type,offset,size,hash,fragments,thumbnail)
+     * @return: true on success
+     */
+    static bool writeTruth(const std::string& path, const std::vector<PlantedFile>& files);
+
+    /**
+     * @brief FNV-1a 64-bit hash used to compare carved files with the ground truth
+     */
+    static uint64_t hash(const uint8_t* data, size_t size);
+
+    // --- File builders (exposed for tests and tools) ---
+    std::vector<uint8_t> makeJpeg(uint32_t width, uint32_t height, bool withThumbnail);
+    std::vector<uint8_t> makePng(uint32_t width, uint32_t height);
+    std::vector<uint8_t> makePdf(size_t objectCount, size_t streamBytes);
+    std::vector<uint8_t> makeZip(size_t entryCount, size_t entryBytes);
+
+private:
+    GenConfig config_;
+    std::mt19937_64 rng_;
+
+    std::vector<uint8_t> makeFile(const std::string& type, bool& hasThumbnail);
+    void fillFree(uint8_t* data, size_t size);
+    uint64_t nextRange(uint64_t lo, uint64_t hi);
+    bool chance(double probability);
+};
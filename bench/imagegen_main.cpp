@@ -0,0 +1,71 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "image_gen.hpp"
+
+static void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options] <output_image>" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --size-mb=N           Image size in MiB (default: 64)" << std::endl;
+    std::cout << "  --seed=N              Random seed (default: 1)" << std::endl;
+    std::cout << "  --fill=F              Fraction of the image holding files (default: 0.5)" << std::endl;
+    std::cout << "  --fragment-rate=F     Fraction of JPG/PDF files split in two (default: 0.1)" << std::endl;
+    std::cout << "  --thumbnail-rate=F    Fraction of JPGs with an EXIF thumbnail (default: 0.2)" << std::endl;
+    std::cout << "  --zero-ratio=F        Fraction of free space that is zeroed (default: 0.3)" << std::endl;
+    std::cout << "Writes <output_image> and <output_image>.truth.csv" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    GenConfig config;
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--size-mb=", 0) == 0) config.imageSize = std::stoull(arg.substr(strlen("--size-mb="))) << 20;
+        else if (arg.rfind("--seed=", 0) == 0) config.seed = std::stoull(arg.substr(strlen("--seed=")));
+        else if (arg.rfind("--fill=", 0) == 0) config.fillRatio = std::stod(arg.substr(strlen("--fill=")));
+        else if (arg.rfind("--fragment-rate=", 0) == 0) config.fragmentRate = std::stod(arg.substr(strlen("--fragment-rate=")));
+        else if (arg.rfind("--thumbnail-rate=", 0) == 0) config.thumbnailRate = std::stod(arg.substr(strlen("--thumbnail-rate=")));
+        else if (arg.rfind("--zero-ratio=", 0) == 0) config.zeroRatio = std::stod(arg.substr(strlen("--zero-ratio=")));
+        else if (arg.rfind("--", 0) == 0 || !outPath.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            outPath = arg;
+        }
+    }
+    if (outPath.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    ImageGenerator generator(config);
+    std::vector<uint8_t> image;
+    std::vector<PlantedFile> planted = generator.generate(image);
+
+    int fd = open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("Error creating image");
+        return 1;
+    }
+    size_t total = 0;
+    while (total < image.size()) {
+        ssize_t n = write(fd, image.data() + total, image.size() - total);
+        if (n <= 0) {
+            perror("Error writing image");
+            close(fd);
+            return 1;
+        }
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+
+    if (!ImageGenerator::writeTruth(outPath + ".truth.csv", planted)) {
+        std::cerr << "Error: Failed to write ground truth" << std::endl;
+        return 1;
+    }
+    std::cout << "[*] Wrote " << image.size() << " bytes with " << planted.size() << " planted files to " << outPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "carver.hpp"
+
+// Options of a batch run over many images
+struct BatchOptions {
+    CarverOptions carver;               // Applied to every image; carver.outputDir is the batch root
+    size_t parallelScans = 0;           // Images scanned at once (0 = hardware concurrency)
+    size_t perDeviceScans = 1;          // Images scanned at once from the same physical disk
+    std::string manifestPath;           // Combined manifest (empty = <outputDir>/manifest.csv)
+};
+
+// One recovered file in the combined manifest
+struct ManifestEntry {
+    std::string extension;
+    uint64_t offset = 0;                // Image offset of the header
+    uint32_t partition = 0;             // Partition holding the header (0 = unpartitioned space)
+    uint64_t partitionOffset = 0;       // Header offset relative to the partition start
+    uint64_t size = 0;                  // Final size on disk
+    std::string status;                 // valid, invalid (tagged), unchecked (validation off) or damaged (bad sectors)
+    std::string path;
+};
+
+// Carves many images with one scheduler: scans run on a shared pool, at most perDeviceScans per disk,
+// and every carver shares one compiled signature matcher and one validation pool.
+class BatchCarver {
+public:
+    /**
+     * @brief Constructor
+     * @param images: Image paths, in manifest order
+     * @param options: Batch options
+     */
+    BatchCarver(const std::vector<std::string>& images, const BatchOptions& options);
+
+    /**
+     * @brief Read an image list: one path per line, blank lines and lines starting with '#' ignored
+     * @param listPath: List file
+     * @param images: Receives the paths
+     * @return: true if the list could be read
+     */
+    static bool readList(const std::string& listPath, std::vector<std::string>& images);
+
+    /**
+     * @brief Carve every image and write the combined manifest
+     * @return: Number of images that could not be carved
+     */
+    size_t run();
+
+    /**
+     * @brief Write the manifest of a single-image run
+     * @param image: Image path as given to the carver
+     * @param outputDir: Directory holding the recovered files
+     * @param mode: Validation policy of the run
+     * @param partitions: Partition table of the image (for partition-relative offsets)
+     * @param path: Manifest file
+     * @return: true on success
+     */
+    static bool writeImageManifest(const std::string& image, const std::string& outputDir, ValidationMode mode,
+                                   const PartitionTable& partitions, const std::string& path);
+
+private:
+    struct Job {
+        std::string image;
+        std::string outputDir;                  // Per-image directory under the batch root
+        uint64_t disk = 0;                      // Physical disk holding the image (scheduling key)
+        bool ok = false;
+        PartitionTable partitions;              // Read by the image's carver
+        std::vector<ManifestEntry> entries;
+    };
+
+    std::vector<std::string> images_;
+    BatchOptions options_;
+
+    /**
+     * @brief Scan one image with the shared resources in `base`
+     */
+    void carveImage(Job& job, const CarverOptions& base);
+
+    /**
+     * @brief Collect the files left in a job's output directory after validation
+     */
+    static void collectOutputs(Job& job, ValidationMode mode);
+
+    /**
+     * @brief Write image,type,offset,partition,partition_offset,size,status,path rows for every job
+     * @return: true on success
+     */
+    static bool writeManifest(const std::vector<Job>& jobs, const std::string& path);
+
+    /**
+     * @brief Identify the physical disk an image lives on (whole disk for partitions, via sysfs)
+     * @return: Device number, or 0 if unknown
+     */
+    static uint64_t diskOf(const std::string& path);
+};
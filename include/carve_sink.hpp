@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "image_source.hpp"
+#include "signature.hpp"
+
+// File currently being carved
+struct CarvedFile {
+    const FileSignature* signature = nullptr;  // Type of the file
+    uint64_t offset = 0;                       // Image offset of the file's header
+    uint64_t size = 0;                         // Bytes delivered so far
+    uint32_t partition = 0;                    // Partition holding the header (0 = unpartitioned space)
+    uint64_t partitionOffset = 0;              // Header offset relative to the start of that partition
+    uint64_t badBytes = 0;                     // Unreadable (zero-filled) bytes inside the file, set before end()
+};
+
+// Consecutive bytes of a carved file.
+// data points into the carver's scan buffer (no copy) and is valid only during the call.
+struct CarveChunk {
+    const CarvedFile* file = nullptr;
+    uint64_t position = 0;                     // Offset of data within the file
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Work a sink accepted but had not completed at checkpoint time (e.g. a file awaiting validation)
+struct SinkPendingItem {
+    std::string name;                          // Sink-specific handle (DirectorySink: output path)
+    std::string extension;                     // Signature of the file
+    uint64_t headerOffset = 0;                 // Image offset of the file's header
+};
+
+// Sink state stored in a checkpoint and handed back on resume; the carver persists it opaquely
+struct SinkState {
+    std::string openFile;                      // Handle of the file still being carved (empty = none)
+    std::vector<SinkPendingItem> pending;      // Unfinished work to requeue
+};
+
+// Receiver of carved files. Every call is made synchronously from the scan thread, so a sink that
+// blocks applies backpressure: the scan waits, and memory stays bounded by the scan buffer.
+class CarveSink {
+public:
+    virtual ~CarveSink() = default;
+
+    /**
+     * @brief Called once before scanning starts
+     * @param image: Image being carved (for sinks that re-read it, e.g. to reassemble fragments)
+     * @return: false to abort the run
+     */
+    virtual bool attach(std::shared_ptr<ImageSource> image) { (void)image; return true; }
+
+    /**
+     * @brief A header was found and a new file starts
+     * @param file: The new file (size 0)
+     * @return: false to skip the file; no chunks are delivered for it
+     */
+    virtual bool begin(const CarvedFile& file) = 0;
+
+    /**
+     * @brief Next bytes of the current file
+     * @param chunk: Bytes and their position in the file
+     * @return: false to stop receiving this file (no end() follows)
+     */
+    virtual bool write(const CarveChunk& chunk) = 0;
+
+    /**
+     * @brief Incremental formats (PDF): bytes past `size` turned out to be junk and must be dropped
+     * @param file: Current file
+     * @param size: New length of the file
+     */
+    virtual void truncate(const CarvedFile& file, uint64_t size) { (void)file; (void)size; }
+
+    /**
+     * @brief The current file is complete
+     * @param file: Finished file with its final size
+     */
+    virtual void end(const CarvedFile& file) = 0;
+
+    /**
+     * @brief Called once after the scan, before the carver returns
+     */
+    virtual void finish() {}
+
+    // --- Checkpoint support (optional) ---
+
+    /**
+     * @brief Make delivered bytes durable and describe the sink state for a checkpoint
+     * @param open: File still being carved, or nullptr
+     * @param state: Receives the handle of the open file and the work not completed yet
+     */
+    virtual void checkpoint(const CarvedFile* open, SinkState& state) { (void)open; (void)state; }
+
+    /**
+     * @brief Continue a file interrupted by a previous run
+     * @param file: File with the size recorded in the checkpoint
+     * @param state: Restored sink state (openFile is the handle checkpoint() gave for this file)
+     * @return: false if the sink cannot append to it; the carver then re-delivers the file from its header
+     */
+    virtual bool reopen(const CarvedFile& file, const SinkState& state) { (void)file; (void)state; return false; }
+
+    /**
+     * @brief Re-queue work recorded as pending by checkpoint()
+     */
+    virtual void requeue(const SinkPendingItem& item, const FileSignature& sig) { (void)item; (void)sig; }
+};
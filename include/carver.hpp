@@ -2,16 +2,62 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <memory>
+#include "carve_sink.hpp"
+#include "image_source.hpp"
+#include "journal.hpp"
+#include "partition_table.hpp"
+#include "signature_matcher.hpp"
+#include "thread_pool.hpp"
+#include "tolerant_source.hpp"
 #include "signature.hpp"
+#include "validation_stage.hpp"
+
+// Tunables for a carving run
+struct CarverOptions {
+    ValidationMode validation = ValidationMode::Tag;     // Policy for candidates failing validation (nothing is deleted unless asked)
+    std::string outputDir = ".";                         // Where the default sink writes recovered files
+    int minScore = 50;                                   // Minimum validation score to keep a file
+    size_t workerThreads = 0;                            // Validation workers (0 = hardware concurrency)
+    GapCarveOptions gap;                                 // Bifragment reassembly of failing JPG/PDF files
+    std::string journalPath;                             // Checkpoint journal (empty = <outputDir>/FILEEdo.journal)
+    uint64_t checkpointInterval = 256ULL * 1024 * 1024;  // Bytes scanned between checkpoints (0 = never)
+    bool resume = false;                                 // Continue from the journal instead of byte 0
+    std::string progressPath;                            // JSON-lines progress output ("-" = stderr, empty = off)
+    uint32_t progressIntervalMs = 1000;                  // Time between progress records
+    bool reportProgress = true;                          // Run a progress reporter for this scan
+    bool tolerateReadErrors = true;                      // Zero-fill unreadable sectors instead of stopping the scan
+    uint32_t sectorSize = 0;                             // Logical sector size (0 = from the partition table, else 512)
+    uint64_t maxBadSkip = 4ULL * 1024 * 1024;            // Largest jump over a damaged area
+    std::string badSectorMapPath;                        // Bad-sector map (empty = <outputDir>/badsectors.map)
+
+    // Scan selection; each selected range becomes a shard of the journal (all empty = the whole image)
+    std::vector<uint32_t> partitions;                    // Partition numbers
+    std::vector<ByteRange> ranges;                       // Image byte ranges
+    bool unallocated = false;                            // Space outside every partition
+
+    // Resources shared by the carvers of a batch run (null = private to this carver)
+    std::shared_ptr<const SignatureMatcher> matcher;     // Compiled signature patterns
+    std::shared_ptr<ThreadPool> validationPool;          // Validation workers
+};
 
 // Class for carving files from a disk image
 class FileCarver {
 public:
     /** 
      * @brief Constructor
-     * @param path: Path to the disk image file
+     * @param path: Path to the disk image (raw file or device, first split segment, gzip/zstd image)
+     * @param options: Carving options
+     */
+    explicit FileCarver(const std::string& path, const CarverOptions& options = CarverOptions());
+
+    /**
+     * @brief Constructor delivering carved files to a custom sink instead of the output directory
+     * @param path: Path to the disk image
+     * @param sink: Receiver of carved files (validation options are not applied; that is the sink's job)
+     * @param options: Carving options
      */
-    explicit FileCarver(const std::string& path);
+    FileCarver(const std::string& path, std::shared_ptr<CarveSink> sink, const CarverOptions& options = CarverOptions());
 
     /** 
      * @brief Destructor
@@ -30,21 +76,39 @@ public:
      */
     void startCarving();
 
+    /**
+     * @brief Partition table read by initialize() (scheme None when the image has none)
+     */
+    const PartitionTable& partitionTable() const { return partitions_; }
+
 private:
     // --- I/O and Disk info ---
     std::string filePath_;                           // Path to the image file
-    int fd_ = -1;                                    // File descriptor for the input file
-    uint64_t diskSize_ = 0;                          // Size of the disk image
+    CarverOptions options_;                          // Options for this run
+    std::shared_ptr<ImageSource> source_;            // Image reader (raw, split or compressed)
+    std::shared_ptr<TolerantImageSource> tolerant_;  // Error tolerant view of source_ (null when disabled)
+    uint64_t diskSize_ = 0;                          // Size of the disk image (0 while unknown)
+    PartitionTable partitions_;                      // Partitions of the image
     const size_t bufferSize_ = 1024 * 1024;          // Buffer size for reading the file
 
     // --- Carving state management ---
     bool isExtracting_ = false;                      // Flag to indicate if currently extracting a file
     uint64_t lastProcessedOffset_ = 0;               // Last processed offset in the disk image
     const FileSignature* activeSignature_ = nullptr; // Currently active file signature being processed
-    int out_fd_ = -1;                     // Output file descriptor
-    std::vector<FileSignature> signatures_; // Vector of file signatures to look for
+    std::shared_ptr<const SignatureMatcher> matcher_; // File signatures to look for, with compiled patterns
     off_t lastValidFooterOffset_ = 0;
 
+    // --- Output ---
+    std::shared_ptr<CarveSink> sink_;                // Receiver of carved files (DirectorySink by default)
+    CarvedFile current_;                             // File currently being extracted
+    bool fileOpen_ = false;                          // The sink accepted the current file and still takes data
+
+    // --- Checkpointing ---
+    std::unique_ptr<CarveJournal> journal_;          // Checkpoint journal (null when disabled)
+    std::vector<ShardCheckpoint> shards_;            // Ranges scanned by this carver and their restored state
+    size_t shard_ = 0;                               // Shard being scanned
+    SinkState resumedSinkState_;                     // Sink state restored from the journal
+
     // --- Private Methods ---
 
     /** 
@@ -77,12 +141,59 @@ private:
     void finishFile();
 
     /**
-     * 
+     * @brief Remember the current output size as the last valid end of an incremental file
+     * @return: void
      */
     void recordCandidateEndOfFile();
 
     /**
-     * 
+     * @brief Close the current file, truncating incremental formats back to their last footer
+     * @return: void
      */
     void finalizeIncrementalFile();
+
+    /**
+     * @brief Turn the scan selection into shards (the whole image when nothing is selected)
+     * @return: false if the selection names a missing partition or lies outside the image
+     */
+    bool buildShards();
+
+    /**
+     * @brief Scan one shard from its current offset to its end
+     * @param currentOffset: Start of the scan; receives the offset reached
+     * @return: void
+     */
+    void scanShard(uint64_t& currentOffset);
+
+    /**
+     * @brief Set the partition of a file from its header offset
+     * @return: void
+     */
+    void locatePartition(CarvedFile& file) const;
+
+    /**
+     * @brief Record how much of the current file lies on unreadable sectors before it is closed
+     * @return: void
+     */
+    void markDamage();
+
+    /**
+     * @brief Write the bad-sector map next to the recovered files
+     * @return: void
+     */
+    void saveBadSectorMap();
+
+    /**
+     * @brief Persist scanner/extractor state so an interrupted run can resume
+     * @param currentOffset: Next read position in the current shard
+     * @param done: true when the current shard has been fully scanned
+     * @return: void
+     */
+    void saveCheckpoint(uint64_t currentOffset, bool done);
+
+    /**
+     * @brief Restore scanner/extractor state from the journal, reopening the interrupted output file
+     * @return: true if the journal matches this image and was applied
+     */
+    bool restoreCheckpoint();
 };
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Checksums shared by the validators, the partition table reader and the benchmark image generator
+class Checksum {
+public:
+    /**
+     * @brief CRC-32 (ISO-HDLC, reflected polynomial 0xEDB88320) as used by PNG chunks, GPT and ZIP
+     * @param data: Bytes to checksum
+     * @param size: Number of bytes
+     * @return: CRC of the whole buffer
+     */
+    static uint32_t crc32(const uint8_t* data, size_t size);
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "carve_sink.hpp"
+#include "validation_stage.hpp"
+
+// Default sink: writes every carved file to <outputDir>/recovered_<offset>.<ext> and validates it.
+// Files overlapping unreadable sectors are kept unvalidated as recovered_<offset>.damaged.<ext>.
+class DirectorySink : public CarveSink {
+public:
+    /**
+     * @brief Constructor
+     * @param outputDir: Directory receiving the files (created if missing)
+     * @param mode: Validation policy (Off = keep every candidate)
+     * @param minScore: Minimum validation score
+     * @param threads: Validation workers
+     * @param gapOptions: Limits for reassembling fragmented files
+     * @param pool: Validation pool shared with other sinks (null = own pool)
+     */
+    DirectorySink(const std::string& outputDir, ValidationMode mode, int minScore, size_t threads,
+                  const GapCarveOptions& gapOptions, std::shared_ptr<ThreadPool> pool = nullptr);
+
+    /**
+     * @brief Destructor: closes a file left open by an aborted run
+     */
+    ~DirectorySink() override;
+
+    bool attach(std::shared_ptr<ImageSource> image) override;
+    bool begin(const CarvedFile& file) override;
+    bool write(const CarveChunk& chunk) override;
+    void truncate(const CarvedFile& file, uint64_t size) override;
+    void end(const CarvedFile& file) override;
+    void finish() override;
+    void checkpoint(const CarvedFile* open, SinkState& state) override;
+    bool reopen(const CarvedFile& file, const SinkState& state) override;
+    void requeue(const SinkPendingItem& item, const FileSignature& sig) override;
+
+private:
+    std::string outputDir_;
+    ValidationMode mode_;
+    int minScore_;
+    size_t threads_;
+    GapCarveOptions gapOptions_;
+    std::shared_ptr<ThreadPool> pool_;
+    std::unique_ptr<ValidationStage> validation_;   // Null when validation is off
+    int fd_ = -1;                                   // Current output file
+    std::string path_;                              // Path of the current output file
+};
@@ -2,10 +2,11 @@
 #define DISK_IO_HPP
 
 #pragma once
+#include "image_source.hpp"
 #include "ntfs_structure.hpp"
+#include <memory>
 #include <string>
 #include <vector>
-#include <fstream>
 
 struct MFT_Segment {
     uint64_t lcn; // Logical Cluster Number
@@ -24,7 +25,7 @@ public:
     bool readVBR(NTFS_VBR& vbr);
     // Read MFT Entry at specific offset
     bool readRaw(uint64_t offset, void* buffer, size_t size);
-    // Read MBR and get partition offset
+    // Read MBR/GPT and get the offset of the first NTFS partition (0 if none)
     uint64_t findNTFSPartitionOffset();
     // Parse Attributes
     void parseAttributes(uint64_t entry_pos, const MFT_ENTRY_HEADER& header);
@@ -34,8 +35,8 @@ public:
     void scanAllMFTSegments(uint64_t partition_offset, uint64_t mft_base_offset, uint32_t bytes_per_cluster, uint32_t entry_size);
 
     private:
-    // Disk image file stream
-    std::ifstream diskImage;
+    // Disk image (raw, split or compressed)
+    std::shared_ptr<ImageSource> diskImage;
 
     // Helper function: Parse Data Runs
     std::vector<MFT_Segment> parseDataRuns(const uint8_t* runlist, size_t max_size);
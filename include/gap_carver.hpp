@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "image_source.hpp"
+#include "signature.hpp"
+
+// Limits for bifragment gap carving
+struct GapCarveOptions {
+    bool enabled = true;                       // Try to reassemble fragmented JPG/PDF candidates
+    uint32_t clusterSize = 4096;               // Fragment boundaries are assumed to be cluster aligned
+    uint32_t maxBackoffClusters = 16;          // Split points tried before the first detected error
+    uint64_t maxGap = 8ULL * 1024 * 1024;      // Largest gap (foreign data) between the two fragments
+    uint64_t maxTail = 8ULL * 1024 * 1024;     // Largest second fragment
+    uint32_t timeBudgetMs = 2000;              // Wall clock budget per file
+    uint64_t workBudgetBytes = 1ULL << 30;     // Bytes validated per file before giving up
+};
+
+// Result of a successful reassembly
+struct GapCarveResult {
+    bool found = false;
+    uint64_t splitOffset = 0;      // Image offset where the first fragment ends
+    uint64_t gapSize = 0;          // Bytes skipped between the fragments
+    int score = 0;                 // Validation score of the reassembled file
+    std::vector<uint8_t> data;     // Reassembled file contents
+};
+
+// Bifragment gap carver: file = image[header, split) + image[split + gap, footer]
+class GapCarver {
+public:
+    /**
+     * @brief Constructor
+     * @param image: Disk image the candidate was carved from
+     * @param options: Search limits
+     */
+    GapCarver(std::shared_ptr<ImageSource> image, const GapCarveOptions& options);
+
+    /**
+     * @brief Check whether gap carving applies to a signature
+     * @param extension: Extension of the candidate
+     * @return: true for formats whose validators can locate a fragmentation point (jpg, pdf)
+     */
+    static bool supports(const std::string& extension);
+
+    /**
+     * @brief Search for a gap that turns a failing candidate into a valid file
+     * @param sig: Signature of the candidate
+     * @param headerOffset: Image offset of the candidate's header
+     * @param validBytes: Length of the prefix the validator accepted
+     * @param minScore: Score a reassembled candidate must reach
+     * @return: Best reassembly found within budget; found == false otherwise
+     */
+    GapCarveResult carve(const FileSignature& sig, uint64_t headerOffset, uint64_t validBytes, int minScore) const;
+
+private:
+    std::shared_ptr<ImageSource> image_;
+    GapCarveOptions options_;
+};
@@ -0,0 +1,182 @@
+#pragma once
+#include <sys/types.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Random-access byte source for a disk image, independent of how the image is stored
+class ImageSource {
+public:
+    virtual ~ImageSource() = default;
+
+    /**
+     * @brief Open the right source for a path: split raw segments (.001, .002, ...),
+     *        gzip or zstd compressed images (by magic bytes), or a plain file / block device
+     * @param path: Image path (first segment for split images)
+     * @return: Opened source, or nullptr on error (reason printed to stderr)
+     */
+    static std::shared_ptr<ImageSource> open(const std::string& path);
+
+    /**
+     * @brief Size of an image without decoding it (no decoder thread is started)
+     * @param path: Image path, as for open()
+     * @param size: Receives the size
+     * @return: true for raw and split images; false for compressed images (size unknown until decoded) or on error
+     */
+    static bool storedSize(const std::string& path, uint64_t& size);
+
+    /**
+     * @brief Read bytes at an absolute image offset. Safe to call from several threads.
+     * @param offset: Image offset
+     * @param buffer: Destination
+     * @param size: Number of bytes wanted
+     * @return: Bytes read (short only at the end of the image), 0 at end, -1 on error
+     */
+    virtual ssize_t readAt(uint64_t offset, void* buffer, size_t size) = 0;
+
+    /**
+     * @brief Image size in bytes; 0 while unknown (streams before they are fully decoded)
+     */
+    virtual uint64_t size() const = 0;
+
+    /**
+     * @brief Whether size() is exact
+     */
+    virtual bool sizeKnown() const { return true; }
+
+    /**
+     * @brief Whether the source is decoded sequentially (backward reads are expensive and the size
+     *        is only known at the end). Fixed by the source type, unlike sizeKnown().
+     */
+    virtual bool isStream() const { return false; }
+
+    /**
+     * @brief Short human readable description for logs
+     */
+    virtual std::string describe() const = 0;
+};
+
+// Plain file or block device read with pread
+class RawImageSource : public ImageSource {
+public:
+    explicit RawImageSource(const std::string& path);
+    ~RawImageSource() override;
+
+    bool open();
+    ssize_t readAt(uint64_t offset, void* buffer, size_t size) override;
+    uint64_t size() const override { return size_; }
+    std::string describe() const override { return "raw image " + path_; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    uint64_t size_ = 0;
+};
+
+// Split raw image (image.001, image.002, ...) presented as one contiguous image
+class SegmentedImageSource : public ImageSource {
+public:
+    explicit SegmentedImageSource(const std::string& firstPath);
+    ~SegmentedImageSource() override;
+
+    /**
+     * @brief Open the first segment and every consecutively numbered segment after it
+     * @return: true if at least the first segment was opened
+     */
+    bool open();
+    ssize_t readAt(uint64_t offset, void* buffer, size_t size) override;
+    uint64_t size() const override { return size_; }
+    std::string describe() const override;
+
+    /**
+     * @brief Check whether a path looks like the first segment of a split image (numeric extension)
+     */
+    static bool isSegmentPath(const std::string& path);
+
+private:
+    struct Segment {
+        int fd;
+        uint64_t start;   // Image offset of the segment's first byte
+        uint64_t size;
+    };
+
+    std::string firstPath_;
+    std::vector<Segment> segments_;
+    uint64_t size_ = 0;
+};
+
+// Compressed image decoded by a background thread into a sliding block cache.
+// Sequential scans are served from the cache; reads behind it restart decoding from the
+// nearest entry of a seek index built while decoding (deflate block boundaries with their
+// 32 KiB window for gzip, frame boundaries for zstd). Only multi-frame zstd (pzstd, seekable
+// format) gets an index: a single-frame image re-decodes from byte 0 on every backward read.
+class CompressedImageSource : public ImageSource {
+public:
+    enum class Codec { Gzip, Zstd };
+
+    CompressedImageSource(const std::string& path, Codec codec);
+    ~CompressedImageSource() override;
+
+    /**
+     * @brief Open the compressed file and start the decoding thread
+     *        (warns when a zstd image's first frame is too large to be indexed)
+     * @return: true on success
+     */
+    bool open();
+    ssize_t readAt(uint64_t offset, void* buffer, size_t size) override;
+    uint64_t size() const override;
+    bool sizeKnown() const override;
+    bool isStream() const override { return true; }
+    std::string describe() const override;
+
+    // Resumable decoder state at an uncompressed offset
+    struct SeekPoint {
+        uint64_t out = 0;               // Uncompressed offset
+        uint64_t in = 0;                // Compressed offset of the next unconsumed byte
+        int bits = 0;                   // Bits of the previous byte still unconsumed (gzip)
+        std::vector<uint8_t> window;    // Dictionary to restore (gzip)
+    };
+
+    class Decoder;
+
+private:
+    struct Block {
+        uint64_t offset;
+        std::vector<uint8_t> data;
+    };
+
+    const size_t blockSize_ = 4 * 1024 * 1024;      // Decoded bytes per cache block
+    const size_t maxBlocks_ = 16;                   // Cache capacity in blocks
+    const uint64_t readAhead_ = 8ULL * 4 * 1024 * 1024; // How far the decoder may run past the furthest read
+    const uint64_t indexSpan_ = 16ULL * 1024 * 1024;  // Minimum distance between seek points
+
+    std::string path_;
+    Codec codec_;
+    int fd_ = -1;
+
+    // --- Background decoding ---
+    std::thread producer_;
+    mutable std::mutex mutex_;
+    std::condition_variable dataReady_;     // A block was appended or decoding ended
+    std::condition_variable spaceReady_;    // Readers moved forward or shutdown
+    std::deque<Block> blocks_;              // Sliding window of decoded data
+    uint64_t frontier_ = 0;                 // End of decoded data
+    uint64_t readCursor_ = 0;               // End of the furthest read so far
+    bool eof_ = false;
+    bool failed_ = false;
+    bool stopping_ = false;
+    std::vector<SeekPoint> index_;          // Ordered by out
+
+    // --- Reads behind the window ---
+    std::mutex randomMutex_;
+    std::unique_ptr<Decoder> randomDecoder_;
+
+    void produce();
+    ssize_t readBehind(uint64_t offset, uint8_t* out, size_t size);
+    std::unique_ptr<Decoder> makeDecoder(const SeekPoint* point, bool collectPoints);
+};
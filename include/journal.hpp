@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scanner and extractor state of one shard (contiguous byte range of the image)
+struct ShardCheckpoint {
+    uint64_t rangeStart = 0;             // First byte of the shard
+    uint64_t rangeEnd = 0;               // One past the last byte of the shard
+    bool done = false;                   // Shard fully scanned
+    uint64_t currentOffset = 0;          // Next read position
+    bool isExtracting = false;           // A file was open at checkpoint time
+    std::string activeExtension;         // Signature of the open file
+    std::string outFileName;             // Open output file
+    uint64_t outFileOffset = 0;          // Image offset of the open file's header
+    uint64_t outFileSize = 0;            // Bytes of the open file that are durable on disk
+    int64_t lastValidFooterOffset = 0;   // Last incremental footer position in the open file
+};
+
+// Finished file that had not been validated yet at checkpoint time
+struct PendingValidation {
+    std::string path;
+    std::string extension;
+    uint64_t headerOffset = 0;
+};
+
+// Complete journal contents
+struct CarveCheckpoint {
+    std::string imagePath;
+    uint64_t imageSize = 0;
+    std::vector<ShardCheckpoint> shards;
+    std::vector<PendingValidation> pending;
+};
+
+// Small text journal, replaced atomically on every save
+class CarveJournal {
+public:
+    /**
+     * @brief Constructor
+     * @param path: Journal file path
+     */
+    explicit CarveJournal(const std::string& path);
+
+    /**
+     * @brief Write a checkpoint (temp file + fsync + rename + directory fsync)
+     * @param checkpoint: State to persist
+     * @return: true on success
+     */
+    bool save(const CarveCheckpoint& checkpoint) const;
+
+    /**
+     * @brief Read the last saved checkpoint
+     * @param checkpoint: Filled on success
+     * @return: true if a well-formed journal was found
+     */
+    bool load(CarveCheckpoint& checkpoint) const;
+
+    const std::string& path() const { return path_; }
+
+    /**
+     * @brief Flush the directory holding a file so a rename into it survives a crash
+     * @param path: File whose parent directory is synced
+     * @return: true on success
+     */
+    static bool syncDirectory(const std::string& path);
+
+private:
+    std::string path_;
+};
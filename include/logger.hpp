@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <string>
+
+// Runtime log verbosity
+enum class LogLevel {
+    Quiet = 0,  // Errors and the final summary only
+    Info = 1,   // Progress and per-file validation outcomes
+    Debug = 2   // Per-file carving events ([Saved], collisions, ...)
+};
+
+// Global verbosity switch; callers test enabled() before formatting a message
+class Logger {
+public:
+    static void setLevel(LogLevel level) { level_.store(static_cast<int>(level), std::memory_order_relaxed); }
+
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) <= level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Parse "quiet", "info" or "debug"
+     * @param name: Level name
+     * @param level: Parsed level on success
+     * @return: true if the name is known
+     */
+    static bool parse(const std::string& name, LogLevel& level) {
+        if (name == "quiet") level = LogLevel::Quiet;
+        else if (name == "info") level = LogLevel::Info;
+        else if (name == "debug") level = LogLevel::Debug;
+        else return false;
+        return true;
+    }
+
+private:
+    static inline std::atomic<int> level_{static_cast<int>(LogLevel::Info)};
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Counters collected across all carving threads
+enum class Counter : size_t {
+    BytesRead,          // Bytes returned by read() from the image
+    BytesScanned,       // Bytes handed to scanBuffer (includes boundary overlap)
+    MatcherNs,          // Time spent in signature searches
+    WriteNs,            // Time spent writing output files
+    Collisions,         // Extractions cut short by another file's header
+    CapHits,            // Extractions stopped at the maximum file size
+    SkippedBytes,       // Image bytes never scanned (resume, read errors)
+    FilesSaved,         // Output files closed
+    Accepted,           // Files passing validation
+    Rejected,           // Files failing validation
+    Reassembled,        // Fragmented files recovered by gap carving
+    BadBytes,           // Unreadable image bytes zero-filled by the tolerant reader
+    DamagedFiles,       // Output files overlapping unreadable sectors
+    Count
+};
+
+// Aggregated view of all thread-local counters
+struct MetricsSnapshot {
+    std::array<uint64_t, static_cast<size_t>(Counter::Count)> values{};
+    std::vector<uint64_t> candidates;    // Headers found, indexed like Metrics::typeNames()
+
+    uint64_t get(Counter c) const { return values[static_cast<size_t>(c)]; }
+};
+
+// Process-wide metrics registry. Each thread increments its own cache-line-aligned slot
+// without contention; readers sum the slots when they need a snapshot.
+class Metrics {
+public:
+    static constexpr size_t MAX_TYPES = 16;
+
+    static Metrics& instance();
+
+    /**
+     * @brief Add to a counter of the calling thread
+     */
+    static void add(Counter c, uint64_t value = 1) {
+        local().values[static_cast<size_t>(c)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Count a header found for a file type registered with setTypeNames()
+     */
+    static void addCandidate(size_t typeIndex) {
+        if (typeIndex < MAX_TYPES) local().candidates[typeIndex].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Name the file types counted by addCandidate (signature order)
+     */
+    void setTypeNames(const std::vector<std::string>& names);
+    std::vector<std::string> typeNames();
+
+    /**
+     * @brief Sum every thread's counters
+     */
+    MetricsSnapshot snapshot();
+
+    /**
+     * @brief Zero all counters (start of a new run)
+     */
+    void reset();
+
+private:
+    struct alignas(64) ThreadSlot {
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> values{};
+        std::array<std::atomic<uint64_t>, MAX_TYPES> candidates{};
+    };
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadSlot>> slots_;    // Slots outlive their threads so totals stay intact
+    std::vector<std::string> typeNames_;
+
+    static ThreadSlot& local();
+    ThreadSlot* registerSlot();
+};
+
+// Times a scope and adds the elapsed nanoseconds to a counter
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Counter counter) : counter_(counter), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        Metrics::add(counter_, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+private:
+    Counter counter_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,135 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "image_source.hpp"
+#include "ntfs_structure.hpp"
+
+// prevent structure alignment
+#pragma pack(push, 1)
+
+// GUID Partition Table header (LBA 1, backup copy in the last LBA)
+struct GPT_HEADER {
+    char signature[8]; // 0x00 - 0x07 "EFI PART"
+    uint32_t revision; // 0x08 - 0x0B Revision (0x00010000)
+    uint32_t header_size; // 0x0C - 0x0F Size of the header (92)
+    uint32_t header_crc32; // 0x10 - 0x13 CRC-32 of the header with this field zeroed
+    uint32_t reserved; // 0x14 - 0x17 Always 0
+    uint64_t current_lba; // 0x18 - 0x1F LBA of this header
+    uint64_t backup_lba; // 0x20 - 0x27 LBA of the other header
+    uint64_t first_usable_lba; // 0x28 - 0x2F First LBA usable by partitions
+    uint64_t last_usable_lba; // 0x30 - 0x37 Last LBA usable by partitions
+    uint8_t disk_guid[16]; // 0x38 - 0x47 Disk GUID
+    uint64_t entries_lba; // 0x48 - 0x4F First LBA of the partition entry array
+    uint32_t num_entries; // 0x50 - 0x53 Number of partition entries
+    uint32_t entry_size; // 0x54 - 0x57 Size of one partition entry (128)
+    uint32_t entries_crc32; // 0x58 - 0x5B CRC-32 of the partition entry array
+};
+
+// GUID Partition Table entry
+struct GPT_ENTRY {
+    uint8_t type_guid[16]; // 0x00 - 0x0F Partition type GUID (all zero = unused)
+    uint8_t unique_guid[16]; // 0x10 - 0x1F Unique partition GUID
+    uint64_t first_lba; // 0x20 - 0x27 First LBA
+    uint64_t last_lba; // 0x28 - 0x2F Last LBA (inclusive)
+    uint64_t attributes; // 0x30 - 0x37 Attribute flags
+    uint16_t name[36]; // 0x38 - 0x7F Partition name (UTF-16LE)
+};
+
+#pragma pack(pop)
+
+// Half-open byte range [start, end) of an image
+struct ByteRange {
+    uint64_t start = 0;
+    uint64_t end = 0;
+};
+
+// One partition of a disk image
+struct Partition {
+    uint32_t number = 0;            // MBR: 1-4 primary slots, 5+ logical; GPT: entry index + 1
+    uint64_t offset = 0;            // Image offset of the first byte
+    uint64_t size = 0;              // Length in bytes
+    std::string type;               // MBR type byte ("0x07") or GPT type GUID
+    std::string typeName;           // Readable type (ntfs, fat32, linux, efi, ...)
+    std::string filesystem;         // Detected from the first sectors (empty = unknown)
+    std::string name;               // GPT partition name
+};
+
+// MBR (with extended/logical partitions) and GPT partition table reader
+class PartitionTable {
+public:
+    enum class Scheme { None, MBR, GPT };
+
+    /**
+     * @brief Read the partition table of an image
+     * @param image: Image to read
+     * @param sectorSize: Logical sector size (0 = detect from the GPT header position or the boot sectors)
+     * @param probeFilesystems: Read each partition's first sectors to fill Partition::filesystem (and to detect
+     *                          4Kn MBR disks). Off for streams, where reads deep into the image force a second decode.
+     * @return: true if a partition table was found
+     */
+    bool read(ImageSource& image, uint32_t sectorSize = 0, bool probeFilesystems = true);
+
+    Scheme scheme() const { return scheme_; }
+    const char* schemeName() const;
+    uint32_t sectorSize() const { return sectorSize_; }
+    const std::vector<Partition>& partitions() const { return partitions_; }
+
+    /**
+     * @brief Partition with a given number
+     * @return: nullptr if there is none
+     */
+    const Partition* find(uint32_t number) const;
+
+    /**
+     * @brief Partition containing an image offset
+     * @return: nullptr for unpartitioned space
+     */
+    const Partition* locate(uint64_t offset) const;
+
+    /**
+     * @brief Ranges of the image outside every partition
+     * @param diskSize: Size of the image
+     */
+    std::vector<ByteRange> unallocated(uint64_t diskSize) const;
+
+    /**
+     * @brief Print the table (one line per partition)
+     */
+    void print(std::ostream& out) const;
+
+private:
+    Scheme scheme_ = Scheme::None;
+    uint32_t sectorSize_ = 512;
+    bool probeFilesystems_ = true;
+    std::vector<Partition> partitions_;
+
+    /**
+     * @brief Read a GPT whose header lives at `lba`
+     * @return: true if the header and its entry array are valid
+     */
+    bool readGPT(ImageSource& image, uint64_t lba, uint32_t sectorSize);
+
+    /**
+     * @brief Read the four MBR slots, following extended partitions
+     */
+    void readMBR(ImageSource& image, const NTFS_MBR& mbr, uint32_t sectorSize);
+
+    /**
+     * @brief Follow the EBR chain of an extended partition
+     * @param extendedLba: First LBA of the extended partition
+     */
+    void readLogical(ImageSource& image, uint64_t extendedLba, uint32_t sectorSize);
+
+    /**
+     * @brief Guess the MBR sector size from where the partitions' boot sectors are found
+     */
+    static uint32_t detectMBRSectorSize(ImageSource& image, const NTFS_MBR& mbr);
+
+    /**
+     * @brief Identify a file system from its boot sector / superblock
+     * @return: Name, or empty if unknown
+     */
+    static std::string detectFilesystem(ImageSource& image, uint64_t offset);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "metrics.hpp"
+
+// Background thread that periodically aggregates Metrics and emits JSON lines with throughput and ETA
+class ProgressReporter {
+public:
+    /**
+     * @brief Constructor
+     * @param path: Destination of the JSON lines ("-" for stderr, empty to disable periodic output)
+     * @param intervalMs: Time between reports
+     * @param totalBytes: Bytes this run is expected to read (for percentage and ETA; 0 = unknown)
+     */
+    ProgressReporter(const std::string& path, uint32_t intervalMs, uint64_t totalBytes);
+
+    /**
+     * @brief Destructor: stops the reporter thread
+     */
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    /**
+     * @brief Start periodic reporting
+     * @return: void
+     */
+    void start();
+
+    /**
+     * @brief Stop periodic reporting, emit the final JSON record and print a summary
+     * @return: void
+     */
+    void finish();
+
+private:
+    std::string path_;
+    uint32_t intervalMs_;
+    uint64_t totalBytes_;
+    FILE* out_ = nullptr;
+    std::chrono::steady_clock::time_point startTime_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    bool finished_ = false;
+
+    void run();
+
+    /**
+     * @brief Format one JSON record
+     * @param snapshot: Aggregated counters
+     * @param final: true for the end-of-run record
+     */
+    std::string formatRecord(const MetricsSnapshot& snapshot, bool final) const;
+};
@@ -5,6 +5,20 @@
 
 class Searcher {
 public:
+    // Needle with its precomputed Horspool skip table (compile once, search many buffers)
+    struct Pattern {
+        std::vector<uint8_t> needle;
+        size_t skip[256];
+    };
+
+    /**
+     * @brief Build the skip table for a needle
+     * 
+     * @param needle The byte pattern to search for
+     * @return compiled pattern
+     */
+    static Pattern compile(const std::vector<uint8_t>& needle);
+
     /**
      * @brief Boyer-Moore-Horspol string search algorithm
      * 
@@ -16,4 +30,16 @@ public:
     static int64_t search(const std::vector<uint8_t>& haystack,
                           const std::vector<uint8_t>& needle,
                           size_t startOffset = 0);
+
+    /**
+     * @brief Boyer-Moore-Horspol search with a precompiled pattern
+     * 
+     * @param haystack The data to search within
+     * @param pattern The compiled byte pattern
+     * @param startOffset The offset in haystack to start searching from
+     * @return index of the first occurrence of the pattern in haystack after startOffset, or -1 if not found
+     */
+    static int64_t search(const std::vector<uint8_t>& haystack,
+                          const Pattern& pattern,
+                          size_t startOffset = 0);
 };
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "searcher.hpp"
+#include "signature.hpp"
+
+// Signature set with compiled header/footer patterns. Immutable after construction, so one instance
+// can be shared by every carver of a batch run.
+class SignatureMatcher {
+public:
+    /**
+     * @brief Compile the patterns of a signature set
+     * @param signatures: Signatures to match
+     */
+    explicit SignatureMatcher(const std::vector<FileSignature>& signatures = SignatureDB::getSignatures());
+
+    const std::vector<FileSignature>& signatures() const { return signatures_; }
+
+    /**
+     * @brief Compiled header / footer of signatures()[index]
+     */
+    const Searcher::Pattern& header(size_t index) const { return headers_[index]; }
+    const Searcher::Pattern& footer(size_t index) const { return footers_[index]; }
+
+    /**
+     * @brief Position of a signature owned by this matcher
+     */
+    size_t indexOf(const FileSignature* sig) const { return static_cast<size_t>(sig - signatures_.data()); }
+
+    /**
+     * @brief Look up a signature by extension
+     * @return: Matching signature or nullptr
+     */
+    const FileSignature* find(const std::string& extension) const;
+
+private:
+    std::vector<FileSignature> signatures_;
+    std::vector<Searcher::Pattern> headers_;
+    std::vector<Searcher::Pattern> footers_;
+};
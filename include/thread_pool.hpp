@@ -0,0 +1,59 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size worker pool with a bounded task queue
+class ThreadPool {
+public:
+    /**
+     * @brief Constructor
+     * @param threads: Number of worker threads (at least 1)
+     * @param maxQueued: Maximum number of pending tasks before submit() blocks
+     */
+    ThreadPool(size_t threads, size_t maxQueued);
+
+    /**
+     * @brief Destructor: drains the queue and joins all workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a task. Blocks while the queue is full (backpressure on the producer)
+     * @param task: Work item to run on a worker thread
+     * @return: void
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Block until every submitted task has finished
+     * @return: void
+     */
+    void wait();
+
+    /**
+     * @brief Number of worker threads
+     */
+    size_t size() const { return workers_.size(); }
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    size_t maxQueued_;
+    size_t running_ = 0;                    // Tasks currently executing
+    bool stopping_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable taskReady_;     // Signalled when a task is queued or on shutdown
+    std::condition_variable spaceReady_;    // Signalled when a queue slot frees up
+    std::condition_variable idle_;          // Signalled when the pool runs out of work
+
+    void workerLoop();
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "image_source.hpp"
+
+// Unreadable byte ranges of an image (merged, sector aligned)
+class BadSectorMap {
+public:
+    struct Range {
+        uint64_t offset;
+        uint64_t length;
+    };
+
+    /**
+     * @brief Record an unreadable range
+     * @return: Bytes that were not in the map yet
+     */
+    uint64_t add(uint64_t offset, uint64_t length);
+
+    /**
+     * @brief Number of unreadable bytes inside [offset, offset + length)
+     */
+    uint64_t overlap(uint64_t offset, uint64_t length) const;
+
+    /**
+     * @brief First recorded range ending after offset
+     * @param range: Receives the range
+     * @return: false if there is none
+     */
+    bool next(uint64_t offset, Range& range) const;
+
+    std::vector<Range> ranges() const;
+    uint64_t badBytes() const;
+
+    /**
+     * @brief Save / load as text, one "offset length" pair (hex) per line
+     * @return: true on success
+     */
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    mutable std::mutex mutex_;
+    std::map<uint64_t, uint64_t> ranges_;   // offset -> end
+};
+
+// Error tolerant view of a source of known size (raw file, block device, split image).
+// A failed read is bisected down to sector granularity; unreadable sectors are zero-filled and recorded.
+// Inside a damaged area the reader skips ahead exponentially (ddrescue style) instead of retrying
+// every sector, then trims back from the first readable sector it lands on. Skipped sectors are
+// recorded as unreadable too, and recorded ranges are never read again.
+class TolerantImageSource : public ImageSource {
+public:
+    /**
+     * @brief Constructor
+     * @param inner: Source to read from (must have a known size)
+     * @param sectorSize: Smallest unit marked bad
+     * @param maxSkip: Largest jump over a damaged area
+     */
+    TolerantImageSource(std::shared_ptr<ImageSource> inner, uint32_t sectorSize, uint64_t maxSkip);
+
+    /**
+     * @brief Read without failing inside the image: unreadable parts come back as zeros
+     * @return: Bytes returned (short only at the end of the image), 0 at end
+     */
+    ssize_t readAt(uint64_t offset, void* buffer, size_t size) override;
+    uint64_t size() const override { return inner_->size(); }
+    bool sizeKnown() const override { return true; }
+    bool isStream() const override { return inner_->isStream(); }
+    std::string describe() const override { return inner_->describe(); }
+
+    BadSectorMap& badSectors() { return badSectors_; }
+
+private:
+    std::shared_ptr<ImageSource> inner_;
+    uint32_t sectorSize_;
+    uint64_t maxSkip_;
+    BadSectorMap badSectors_;
+    std::mutex skipMutex_;
+    uint64_t skip_ = 0;                 // Jump reached when the last read ended inside a damaged area (0 = none)
+    uint64_t skipEnd_ = 0;              // End offset of that read; only a read starting there inherits skip_
+
+    /**
+     * @brief Read the longest readable prefix of a range, bisecting on sector boundaries
+     * @return: Length of the prefix; the sector right after it is unreadable unless it equals length
+     */
+    uint64_t readPrefix(uint64_t offset, uint8_t* out, uint64_t length);
+
+    /**
+     * @brief Read the longest readable suffix of a range (trimming back from a readable sector)
+     * @return: Length of the suffix
+     */
+    uint64_t readSuffix(uint64_t offset, uint8_t* out, uint64_t length);
+
+    /**
+     * @brief Record [from, to) as unreadable, widened to whole sectors
+     */
+    void markBad(uint64_t from, uint64_t to);
+
+    /**
+     * @brief Read a range that may contain bad sectors, filling `out` completely
+     */
+    void readSlow(uint64_t offset, uint8_t* out, uint64_t length);
+
+    uint64_t alignDown(uint64_t value) const { return value - value % sectorSize_; }
+};
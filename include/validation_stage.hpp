@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "carve_sink.hpp"
+#include "gap_carver.hpp"
+#include "signature.hpp"
+#include "thread_pool.hpp"
+
+// What to do with carved files that fail structural validation
+enum class ValidationMode {
+    Off,        // Keep every candidate untouched
+    Tag,        // Rename rejected candidates to "<name>.invalid"
+    Discard     // Delete rejected candidates
+};
+
+// Post-carve validation pipeline: finished files are scored on a worker pool while the scan continues.
+// Failing JPG/PDF candidates get a bifragment gap-carving attempt before the policy is applied.
+class ValidationStage {
+public:
+    /**
+     * @brief Constructor
+     * @param mode: Policy applied to rejected candidates
+     * @param minScore: Candidates scoring below this are rejected (0 - 100)
+     * @param threads: Number of validation workers
+     * @param image: Source image, re-read when reassembling fragmented files
+     * @param gapOptions: Limits for gap carving
+     * @param pool: Worker pool shared with other stages (null = own pool of `threads` workers)
+     */
+    ValidationStage(ValidationMode mode, int minScore, size_t threads,
+                    std::shared_ptr<ImageSource> image, const GapCarveOptions& gapOptions,
+                    std::shared_ptr<ThreadPool> pool = nullptr);
+
+    /**
+     * @brief Queue a finished output file for validation
+     * @param path: Path of the carved file
+     * @param sig: Signature that produced it
+     * @param headerOffset: Image offset of the file's header
+     * @return: void
+     */
+    void submit(const std::string& path, const FileSignature& sig, uint64_t headerOffset);
+
+    /**
+     * @brief Wait for all validations queued by this stage and print a summary
+     * @return: void
+     */
+    void drain();
+
+    /**
+     * @brief Snapshot of files submitted but not validated yet (recorded in checkpoints)
+     * @return: Queued and in-progress validations
+     */
+    std::vector<SinkPendingItem> pending();
+
+private:
+    ValidationMode mode_;
+    int minScore_;
+    std::shared_ptr<ThreadPool> pool_;
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> reassembled_{0};
+    GapCarver gapCarver_;
+    std::mutex logMutex_;
+    std::mutex pendingMutex_;
+    std::map<std::string, SinkPendingItem> pending_;    // Keyed by output path
+    size_t inFlight_ = 0;                               // Tasks of this stage not finished yet
+    std::condition_variable idle_;                      // Signalled when inFlight_ drops to 0
+
+    /**
+     * @brief Worker body: load, score and apply the policy to one file
+     */
+    void validateFile(const std::string& path, const FileSignature& sig, uint64_t headerOffset);
+
+    /**
+     * @brief Replace the contents of an output file
+     * @return: true if every byte was written
+     */
+    static bool writeFile(const std::string& path, const std::vector<uint8_t>& data);
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Outcome of a structural check on a carved candidate
+struct ValidationResult {
+    int score = 0;            // 0 (garbage) - 100 (structurally sound)
+    size_t validBytes = 0;    // Length of the prefix that parsed cleanly (first suspicious byte)
+    std::string reason;       // Short human readable explanation, empty when fully valid
+};
+
+// Format-aware structural validators for carved files
+class Validator {
+public:
+    /**
+     * @brief Dispatch to the validator matching the file extension
+     * @param extension: Extension of the signature that produced the candidate ("jpg", "png", "pdf")
+     * @param data: Candidate bytes
+     * @param size: Number of candidate bytes
+     * @return: Validation result; unknown extensions are accepted with score 100
+     */
+    static ValidationResult validate(const std::string& extension, const uint8_t* data, size_t size);
+
+    /**
+     * @brief JPEG: marker structure, DQT/DHT/SOF/SOS sanity and baseline Huffman decoding of the scans
+     */
+    static ValidationResult validateJpeg(const uint8_t* data, size_t size);
+
+    /**
+     * @brief PNG: chunk layout, IHDR sanity and CRC-32 of every chunk
+     */
+    static ValidationResult validatePng(const uint8_t* data, size_t size);
+
+    /**
+     * @brief PDF: header, startxref target and classic xref entries pointing at "N G obj"
+     */
+    static ValidationResult validatePdf(const uint8_t* data, size_t size);
+};
@@ -0,0 +1,252 @@
+#include "batch.hpp"
+#include "logger.hpp"
+#include "progress.hpp"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+/* --- Helper --- */
+
+namespace {
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Quote a CSV field when it contains a separator or a quote
+std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) return value;
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+} // namespace
+
+/* --- BatchCarver --- */
+
+BatchCarver::BatchCarver(const std::vector<std::string>& images, const BatchOptions& options)
+    : images_(images), options_(options) {}
+
+bool BatchCarver::readList(const std::string& listPath, std::vector<std::string>& images) {
+    std::ifstream in(listPath);
+    if (!in.is_open()) {
+        std::cerr << "Error: Failed to open image list: " << listPath << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        line.erase(0, line.find_first_not_of(" \t"));
+        if (line.empty() || line[0] == '#') continue;
+        images.push_back(line);
+    }
+    return true;
+}
+
+uint64_t BatchCarver::diskOf(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return 0;
+    dev_t dev = S_ISBLK(st.st_mode) ? st.st_rdev : st.st_dev;
+
+    // A partition shares the disk's I/O queue: schedule by its parent device
+    std::string sys = "/sys/dev/block/" + std::to_string(major(dev)) + ":" + std::to_string(minor(dev));
+    if (access((sys + "/partition").c_str(), F_OK) == 0) {
+        std::ifstream parent(sys + "/../dev");
+        unsigned int maj, min;
+        char colon;
+        if (parent >> maj >> colon >> min) dev = makedev(maj, min);
+    }
+    return static_cast<uint64_t>(dev);
+}
+
+size_t BatchCarver::run() {
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t parallel = options_.parallelScans ? options_.parallelScans : hardware;
+    const size_t perDevice = std::max<size_t>(1, options_.perDeviceScans);
+    const std::string root = options_.carver.outputDir.empty() ? "." : options_.carver.outputDir;
+
+    if (mkdir(root.c_str(), 0755) == -1 && errno != EEXIST) {
+        perror("Error creating output directory");
+        return images_.size();
+    }
+
+    // 1. Jobs: one output directory per image, numbered in list order
+    std::vector<Job> jobs(images_.size());
+    uint64_t totalBytes = 0;
+    bool sizesKnown = true;
+    for (size_t i = 0; i < images_.size(); ++i) {
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "%03zu_", i + 1);
+        jobs[i].image = images_[i];
+        jobs[i].outputDir = root + "/" + prefix + baseName(images_[i]);
+        jobs[i].disk = diskOf(images_[i]);
+
+        // Opening a compressed image would start its decoder just to learn nothing: its size stays unknown
+        uint64_t size = 0;
+        if (ImageSource::storedSize(images_[i], size)) totalBytes += size;
+        else sizesKnown = false;
+    }
+
+    // 2. Resources shared by every carver
+    size_t validationThreads = options_.carver.workerThreads ? options_.carver.workerThreads : hardware;
+    CarverOptions base = options_.carver;
+    base.matcher = std::make_shared<const SignatureMatcher>();
+    base.validationPool = std::make_shared<ThreadPool>(validationThreads, validationThreads * 2);
+    base.reportProgress = false; // One report for the whole batch
+
+    ProgressReporter progress(options_.carver.progressPath, options_.carver.progressIntervalMs,
+                              sizesKnown ? totalBytes : 0);
+    progress.start();
+
+    // 3. Schedule: first queued image whose disk has a free slot, up to `parallel` scans in total
+    ThreadPool scanPool(parallel, parallel);
+    std::mutex mutex;
+    std::condition_variable slotFree;
+    std::map<uint64_t, size_t> busy;    // Running scans per disk
+    std::vector<bool> started(jobs.size(), false);
+    size_t running = 0;
+    size_t finished = 0;
+
+    for (size_t scheduled = 0; scheduled < jobs.size(); ++scheduled) {
+        size_t pick = jobs.size();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFree.wait(lock, [&] {
+                if (running >= parallel) return false;
+                for (size_t i = 0; i < jobs.size(); ++i) {
+                    if (!started[i] && busy[jobs[i].disk] < perDevice) {
+                        pick = i;
+                        return true;
+                    }
+                }
+                return false;
+            });
+            started[pick] = true;
+            busy[jobs[pick].disk]++;
+            running++;
+        }
+
+        scanPool.submit([&, pick] {
+            carveImage(jobs[pick], base);
+            std::lock_guard<std::mutex> lock(mutex);
+            busy[jobs[pick].disk]--;
+            running--;
+            finished++;
+            if (Logger::enabled(LogLevel::Info)) {
+                std::cout << "[*] [" << finished << "/" << jobs.size() << "] " << jobs[pick].image << ": "
+                          << (jobs[pick].ok ? std::to_string(jobs[pick].entries.size()) + " files" : "failed")
+                          << std::endl;
+            }
+            slotFree.notify_all();
+        });
+    }
+    scanPool.wait();
+    progress.finish();
+
+    // 4. Combined manifest
+    std::string manifestPath = options_.manifestPath.empty() ? root + "/manifest.csv" : options_.manifestPath;
+    if (!writeManifest(jobs, manifestPath)) {
+        std::cerr << "Error: Failed to write manifest " << manifestPath << std::endl;
+    } else {
+        std::cout << "[*] Manifest: " << manifestPath << std::endl;
+    }
+
+    return static_cast<size_t>(std::count_if(jobs.begin(), jobs.end(), [](const Job& job) { return !job.ok; }));
+}
+
+void BatchCarver::carveImage(Job& job, const CarverOptions& base) {
+    CarverOptions options = base;
+    options.outputDir = job.outputDir;
+    options.journalPath = job.outputDir + "/FILEEdo.journal";
+    // Images that never started have no journal yet and simply start from byte 0
+    options.resume = base.resume && access(options.journalPath.c_str(), F_OK) == 0;
+
+    FileCarver carver(job.image, options);
+    if (!carver.initialize()) return;
+    carver.startCarving();
+    job.ok = true;
+    job.partitions = carver.partitionTable();
+    collectOutputs(job, options_.carver.validation);
+}
+
+bool BatchCarver::writeImageManifest(const std::string& image, const std::string& outputDir, ValidationMode mode,
+                                     const PartitionTable& partitions, const std::string& path) {
+    std::vector<Job> jobs(1);
+    jobs[0].image = image;
+    jobs[0].outputDir = outputDir.empty() ? "." : outputDir;
+    jobs[0].ok = true;
+    jobs[0].partitions = partitions;
+    collectOutputs(jobs[0], mode);
+    return writeManifest(jobs, path);
+}
+
+void BatchCarver::collectOutputs(Job& job, ValidationMode mode) {
+    DIR* dir = opendir(job.outputDir.c_str());
+    if (!dir) return;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        unsigned long long offset;
+        char ext[16];
+        if (sscanf(name.c_str(), "recovered_%llu.%15[a-z]", &offset, ext) != 2) continue;
+        bool damaged = strcmp(ext, "damaged") == 0;
+        if (damaged && sscanf(name.c_str(), "recovered_%llu.damaged.%15[a-z]", &offset, ext) != 2) continue;
+
+        ManifestEntry file;
+        file.extension = ext;
+        file.offset = offset;
+        file.path = job.outputDir + "/" + name;
+        if (const Partition* p = job.partitions.locate(offset)) {
+            file.partition = p->number;
+            file.partitionOffset = offset - p->offset;
+        }
+        if (damaged) file.status = "damaged";
+        else if (mode == ValidationMode::Off) file.status = "unchecked";
+        else if (name.size() > 8 && name.compare(name.size() - 8, 8, ".invalid") == 0) file.status = "invalid";
+        else file.status = "valid";
+
+        struct stat st;
+        if (stat(file.path.c_str(), &st) == 0) file.size = static_cast<uint64_t>(st.st_size);
+        job.entries.push_back(file);
+    }
+    closedir(dir);
+
+    std::sort(job.entries.begin(), job.entries.end(),
+              [](const ManifestEntry& a, const ManifestEntry& b) { return a.offset < b.offset; });
+}
+
+bool BatchCarver::writeManifest(const std::vector<Job>& jobs, const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    // partition and partition_offset stay empty for files outside every partition
+    out << "image,type,offset,partition,partition_offset,size,status,path\n";
+    for (const auto& job : jobs) {
+        if (!job.ok) {
+            out << csvField(job.image) << ",,,,,,error,\n";
+            continue;
+        }
+        for (const auto& file : job.entries) {
+            out << csvField(job.image) << ',' << file.extension << ',' << file.offset << ',';
+            if (file.partition) out << file.partition << ',' << file.partitionOffset << ',';
+            else out << ",,";
+            out << file.size << ',' << file.status << ',' << csvField(file.path) << '\n';
+        }
+    }
+    return out.good();
+}
@@ -1,70 +1,252 @@
 #include "carver.hpp"
+#include "directory_sink.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "progress.hpp"
 #include "searcher.hpp"
-#include <fcntl.h>
-#include <unistd.h>
 #include <iostream>
 #include <cstring>
+#include <thread>
+#include <algorithm>
 
 
-FileCarver::FileCarver(const std::string& path) : filePath_(path) {}
+FileCarver::FileCarver(const std::string& path, const CarverOptions& options)
+    : filePath_(path), options_(options) {}
 
-FileCarver::~FileCarver() {
-    if (fd_ != -1) close(fd_);
-    if (out_fd_ != -1) close(out_fd_);
-}
+FileCarver::FileCarver(const std::string& path, std::shared_ptr<CarveSink> sink, const CarverOptions& options)
+    : filePath_(path), options_(options), sink_(std::move(sink)) {}
+
+FileCarver::~FileCarver() {}
 
 bool FileCarver::initialize() {
-    fd_ = open(filePath_.c_str(), O_RDONLY | O_LARGEFILE);
-    if (fd_ < 0) {
-        perror("Error opening file");
-        return false;
+    source_ = ImageSource::open(filePath_);
+    if (!source_) return false;
+
+    // The table also tells the logical sector size (GPT header position, 4Kn MBR disks). On a stream every
+    // read past the decoder restarts decoding later, so the table is read only when --partitions needs it,
+    // and the partitions' file systems are not probed.
+    bool stream = source_->isStream();
+    if ((!stream || !options_.partitions.empty()) && partitions_.read(*source_, options_.sectorSize, !stream) &&
+        Logger::enabled(LogLevel::Info)) {
+        partitions_.print(std::cout);
+    }
+    uint32_t sectorSize = options_.sectorSize ? options_.sectorSize : partitions_.sectorSize();
+
+    // Streams cannot be re-read around an error; only sources of known size get the tolerant view
+    if (options_.tolerateReadErrors && !stream) {
+        tolerant_ = std::make_shared<TolerantImageSource>(source_, sectorSize, options_.maxBadSkip);
+        source_ = tolerant_;
+        if (options_.badSectorMapPath.empty()) {
+            options_.badSectorMapPath = (options_.outputDir.empty() ? "." : options_.outputDir) + "/badsectors.map";
+        }
+    }
+
+    // Streams count as size 0 even when the decoder has already reached the end, so the journal and
+    // the shard layout do not depend on how far decoding got before this point
+    diskSize_ = stream ? 0 : source_->size();
+    if (Logger::enabled(LogLevel::Info)) {
+        std::cout << "[*] Source: " << source_->describe();
+        if (!stream) std::cout << ", " << diskSize_ << " bytes";
+        std::cout << std::endl;
+    }
+    if (!buildShards()) return false;
+    matcher_ = options_.matcher ? options_.matcher : std::make_shared<const SignatureMatcher>();
+
+    std::vector<std::string> typeNames;
+    for (const auto& sig : matcher_->signatures()) typeNames.push_back(sig.extension);
+    Metrics::instance().setTypeNames(typeNames);
+
+    if (!sink_) {
+        size_t threads = options_.workerThreads;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        sink_ = std::make_shared<DirectorySink>(options_.outputDir, options_.validation, options_.minScore, threads,
+                                                options_.gap, options_.validationPool);
+    }
+    if (!sink_->attach(source_)) return false;
+
+    if (options_.checkpointInterval > 0 || options_.resume) {
+        if (options_.journalPath.empty()) {
+            options_.journalPath = (options_.outputDir.empty() ? "." : options_.outputDir) + "/FILEEdo.journal";
+        }
+        journal_ = std::make_unique<CarveJournal>(options_.journalPath);
+    }
+    if (options_.resume && !restoreCheckpoint()) return false;
+    // Sectors found bad by the previous run are not read again
+    if (options_.resume && tolerant_) tolerant_->badSectors().load(options_.badSectorMapPath);
+    return true;
+}
+
+bool FileCarver::buildShards() {
+    std::vector<ByteRange> selected;
+    bool knownSize = !source_->isStream();
+
+    for (uint32_t number : options_.partitions) {
+        const Partition* p = partitions_.find(number);
+        if (!p) {
+            std::cerr << "Error: Image has no partition " << number << std::endl;
+            return false;
+        }
+        selected.push_back(ByteRange{p->offset, p->offset + p->size});
+    }
+    for (const auto& range : options_.ranges) {
+        if (range.start >= range.end || (knownSize && range.start >= diskSize_)) {
+            std::cerr << "Error: Range " << range.start << "-" << range.end << " lies outside the image" << std::endl;
+            return false;
+        }
+        selected.push_back(range);
+    }
+    if (options_.unallocated) {
+        if (!knownSize) {
+            std::cerr << "Error: Unallocated space needs an image of known size" << std::endl;
+            return false;
+        }
+        for (const auto& gap : partitions_.unallocated(diskSize_)) selected.push_back(gap);
     }
 
-    diskSize_ = lseek64(fd_, 0, SEEK_END);          // Get the size of the disk image
-    lseek64(fd_, 0, SEEK_SET);                      // Reset file offset to the beginning
-    signatures_ = SignatureDB::getSignatures();     // Load file signatures
+    shards_.clear();
+    if (options_.partitions.empty() && options_.ranges.empty() && !options_.unallocated) {
+        ShardCheckpoint whole;
+        whole.rangeEnd = knownSize ? diskSize_ : UINT64_MAX;
+        shards_.push_back(whole);
+        return true;
+    }
+
+    // Clip to the image and merge overlaps so no byte is carved twice
+    std::sort(selected.begin(), selected.end(), [](const ByteRange& a, const ByteRange& b) { return a.start < b.start; });
+    for (auto range : selected) {
+        if (knownSize) range.end = std::min(range.end, diskSize_);
+        if (range.start >= range.end) continue;
+        if (!shards_.empty() && range.start <= shards_.back().rangeEnd) {
+            shards_.back().rangeEnd = std::max(shards_.back().rangeEnd, range.end);
+            continue;
+        }
+        ShardCheckpoint shard;
+        shard.rangeStart = range.start;
+        shard.rangeEnd = range.end;
+        shard.currentOffset = range.start;
+        shards_.push_back(shard);
+    }
+
+    if (Logger::enabled(LogLevel::Info)) {
+        uint64_t total = 0;
+        for (const auto& shard : shards_) total += shard.rangeEnd - shard.rangeStart;
+        std::cout << "[*] Scanning " << shards_.size() << " range(s), " << total << " bytes" << std::endl;
+    }
     return true;
 }
 
 void FileCarver::startCarving() {
+    if (shards_.empty()) {
+        std::cout << "[*] The selection contains no bytes to scan." << std::endl;
+        return;
+    }
+    if (std::all_of(shards_.begin(), shards_.end(), [](const ShardCheckpoint& s) { return s.done; })) {
+        std::cout << "[*] Journal marks this image as fully scanned. Nothing to resume." << std::endl;
+        return;
+    }
+
+    // Re-queue files whose validation was interrupted
+    for (const auto& item : resumedSinkState_.pending) {
+        const FileSignature* sig = matcher_->find(item.extension);
+        if (sig) sink_->requeue(item, *sig);
+    }
+    resumedSinkState_ = SinkState();
+
+    uint64_t remaining = 0;
+    for (const auto& shard : shards_) {
+        Metrics::add(Counter::SkippedBytes, shard.currentOffset - shard.rangeStart); // Covered by the previous run
+        uint64_t end = shard.rangeEnd == UINT64_MAX ? diskSize_ : shard.rangeEnd;
+        if (!shard.done && end > shard.currentOffset) remaining += end - shard.currentOffset;
+    }
+    std::unique_ptr<ProgressReporter> progress;
+    if (options_.reportProgress) {
+        progress = std::make_unique<ProgressReporter>(options_.progressPath, options_.progressIntervalMs, remaining);
+        progress->start();
+    }
+
+    for (shard_ = 0; shard_ < shards_.size(); ++shard_) {
+        if (shards_[shard_].done) continue;
+        uint64_t currentOffset = shards_[shard_].currentOffset;
+        scanShard(currentOffset);
+
+        // Files do not continue past the end of their partition or range
+        if (isExtracting_) finalizeIncrementalFile();
+        if (options_.checkpointInterval > 0) saveCheckpoint(currentOffset, true);
+    }
+    shard_ = shards_.size() - 1;
+
+    sink_->finish();
+    if (options_.checkpointInterval > 0) saveCheckpoint(shards_[shard_].currentOffset, true);
+    if (tolerant_ && tolerant_->badSectors().badBytes() > 0) {
+        saveBadSectorMap();
+        std::cout << "[-] " << tolerant_->badSectors().badBytes() << " unreadable bytes in "
+                  << tolerant_->badSectors().ranges().size() << " ranges, map: " << options_.badSectorMapPath
+                  << std::endl;
+    }
+    if (progress) progress->finish();
+}
+
+void FileCarver::scanShard(uint64_t& currentOffset) {
     std::vector<uint8_t> buffer(bufferSize_);   // Buffer for reading file data
-    uint64_t currentOffset = 0;                 // Current offset in the disk image
+    const uint64_t rangeEnd = shards_[shard_].rangeEnd;
     const size_t overlap = 16;                  // Overlap size to handle signatures across buffer boundaries
-
-    while (currentOffset < diskSize_) {
-        lseek64(fd_, currentOffset, SEEK_SET);
-        ssize_t bytesRead = read(fd_, buffer.data(), bufferSize_);
-        if (bytesRead <= 0) break; // Error or end(0) of file
+    uint64_t sinceCheckpoint = 0;               // Bytes scanned since the last checkpoint
+
+    // Read until the shard ends or the source reports its end; compressed streams learn their size only there
+    while (currentOffset < rangeEnd) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(bufferSize_, rangeEnd - currentOffset));
+        buffer.resize(want);
+        ssize_t bytesRead = source_->readAt(currentOffset, buffer.data(), want);
+        if (bytesRead <= 0) {
+            // Error or end(0) of file; the tolerant reader only fails on streams
+            if (bytesRead < 0) {
+                perror("[-] Error reading image");
+                uint64_t end = std::min(rangeEnd, diskSize_);
+                if (end > currentOffset) Metrics::add(Counter::SkippedBytes, end - currentOffset);
+            }
+            break;
+        }
+        Metrics::add(Counter::BytesRead, bytesRead);
         
-        if (static_cast<size_t>(bytesRead) < bufferSize_) buffer.resize(bytesRead);
+        if (static_cast<size_t>(bytesRead) < want) buffer.resize(bytesRead);
 
         scanBuffer(buffer, currentOffset);
         
-        if (isExtracting_) currentOffset += bytesRead;
-        else {
-            if (currentOffset + bytesRead < diskSize_) {
-                currentOffset += bytesRead - overlap;
-            } else {
-            currentOffset += bytesRead;
-            }
+        // Full buffer = more data follows; keep a small overlap for headers crossing the boundary
+        bool atEnd = static_cast<size_t>(bytesRead) < want || currentOffset + bytesRead >= rangeEnd ||
+                     (diskSize_ > 0 && currentOffset + bytesRead >= diskSize_);
+        if (isExtracting_ || atEnd) currentOffset += bytesRead;
+        else currentOffset += bytesRead - overlap;
+
+        sinceCheckpoint += bytesRead;
+        if (options_.checkpointInterval > 0 && sinceCheckpoint >= options_.checkpointInterval) {
+            saveCheckpoint(currentOffset, false);
+            sinceCheckpoint = 0;
         }
+        if (atEnd) break;
     }
 }
 
 void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t currentOffset) {
     size_t currentBufferIdx = 0;
     size_t bufferSize = buffer.size();
+    Metrics::add(Counter::BytesScanned, bufferSize);
 
     while (currentBufferIdx < bufferSize) {
         // Search Header
         if (!isExtracting_) {
-            bool foundHeader = false;
             int64_t bestFoundIdx = -1;
             const FileSignature* bestSig = nullptr;
 
             // Find the earliest header in the buffer
-            for (const auto& sig : signatures_) {
-                int64_t foundIdx = Searcher::search(buffer, sig.header, currentBufferIdx);
+            const std::vector<FileSignature>& signatures = matcher_->signatures();
+            for (size_t i = 0; i < signatures.size(); ++i) {
+                const FileSignature& sig = signatures[i];
+                int64_t foundIdx;
+                {
+                    ScopedTimer timer(Counter::MatcherNs);
+                    foundIdx = Searcher::search(buffer, matcher_->header(i), currentBufferIdx);
+                }
                 if (foundIdx != -1) {
                     if (bestFoundIdx == -1 || foundIdx < bestFoundIdx) {
                         bestFoundIdx = foundIdx;
@@ -80,11 +262,12 @@ void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t current
                 activeSignature_ = bestSig;
 
                 uint64_t headerOffset = currentOffset + foundPos;
+                Metrics::addCandidate(matcher_->indexOf(bestSig));
                 startNewFile(headerOffset);
                 writeData(bestSig->header.data(), bestSig->header.size());
 
-                if (bestSig->extension == "pdf") {
-                    std::cout << "[Debug] Found PDF Start at offset: " << headerOffset << std::endl;
+                if (bestSig->extension == "pdf" && Logger::enabled(LogLevel::Debug)) {
+                    std::cout << "[Debug] Found PDF Start at offset: " << headerOffset << '\n';
                 }
 
                 currentBufferIdx = foundPos + bestSig->header.size();
@@ -98,7 +281,6 @@ void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t current
         
         // Data extraction and collision/Footer detection
         else {
-            size_t writeEndIdx = bufferSize; // 기본적으로 버퍼 끝까지 씀
             bool collisionDetected = false;
             size_t collisionIdx = 0;
 
@@ -106,14 +288,19 @@ void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t current
             // When extracting PDF, ignore JPG headers (FF D8) due to Embedded Images
             // But if other PDF or PNG headers appear, we should stop.
             
-            for (const auto& sig : signatures_) {
+            const std::vector<FileSignature>& signatures = matcher_->signatures();
+            for (size_t i = 0; i < signatures.size(); ++i) {
                 // When extracting PDF: only consider same PDF headers or PNG headers as collisions (ignore JPG)
                 if (activeSignature_->extension == "pdf") {
-                    if (sig.extension == "jpg") continue; 
+                    if (signatures[i].extension == "jpg") continue; 
                 }
 
                 // Search from current position
-                int64_t foundIdx = Searcher::search(buffer, sig.header, currentBufferIdx);
+                int64_t foundIdx;
+                {
+                    ScopedTimer timer(Counter::MatcherNs);
+                    foundIdx = Searcher::search(buffer, matcher_->header(i), currentBufferIdx);
+                }
                 
                 // If found and within current processing range, it's a collision!
                 if (foundIdx != -1) {
@@ -128,7 +315,8 @@ void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t current
             // 2. [Footer Search] Search for the active file's footer
             int64_t footerIdx = -1;
             if (activeSignature_->hasFooter) {
-                footerIdx = Searcher::search(buffer, activeSignature_->footer, currentBufferIdx);
+                ScopedTimer timer(Counter::MatcherNs);
+                footerIdx = Searcher::search(buffer, matcher_->footer(matcher_->indexOf(activeSignature_)), currentBufferIdx);
             }
 
             // Footer vs New Header vs Buffer End
@@ -138,7 +326,10 @@ void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t current
                 // Write data up to collision point
                 writeData(buffer.data() + currentBufferIdx, collisionIdx - currentBufferIdx);
                 
-                std::cout << "[Debug] Collision detected! Switching file..." << std::endl;
+                Metrics::add(Counter::Collisions);
+                if (Logger::enabled(LogLevel::Debug)) {
+                    std::cout << "[Debug] Collision detected! Switching file..." << '\n';
+                }
                 
                 // Force close current file
                 finalizeIncrementalFile(); 
@@ -157,6 +348,11 @@ void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t current
                 if (foundPos > currentBufferIdx) {
                     writeData(buffer.data() + currentBufferIdx, foundPos - currentBufferIdx);
                 }
+                // The size cap may have closed the file; resume header search at the footer
+                if (!isExtracting_) {
+                    currentBufferIdx = foundPos;
+                    continue;
+                }
                 
                 // Write Footer
                 writeData(activeSignature_->footer.data(), activeSignature_->footer.size());
@@ -183,67 +379,173 @@ void FileCarver::scanBuffer(const std::vector<uint8_t>& buffer, uint64_t current
     }
 }
 void FileCarver::startNewFile(uint64_t offset) {
-    std::string fileName = "recovered_" + std::to_string(offset) + "." + activeSignature_->extension;
-
-    // O_WRONLY: Open for write only
-    // O_CREAT: Create file if it does not exist
-    // O_TRUNC: Truncate file to zero length if it already exists
-    // 0644: File permissions - owner can read/write, others can read
-    out_fd_ = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (out_fd_ == -1) {
-        std::cerr << "Error creating file: " << fileName << std::endl;
-    }
+    current_ = CarvedFile{activeSignature_, offset, 0};
+    locatePartition(current_);
+    lastValidFooterOffset_ = 0;
+    fileOpen_ = sink_->begin(current_);
 }
 
 void FileCarver::writeData(const uint8_t* data, size_t size) {
-    if (out_fd_ < 0) return;
+    if (!fileOpen_) return;
 
-    const off_t MAX_FILE_SIZE = 100 * 1024 * 1024; // 100 MB
-    off_t currentSize = lseek(out_fd_, 0, SEEK_CUR);
+    const uint64_t MAX_FILE_SIZE = 100 * 1024 * 1024; // 100 MB
 
-    if (currentSize + static_cast<off_t>(size) > MAX_FILE_SIZE) {
-        std::cerr << "[-] Max file size reached. Force finalizing." << std::endl;
+    if (current_.size + size > MAX_FILE_SIZE) {
+        Metrics::add(Counter::CapHits);
+        if (Logger::enabled(LogLevel::Info)) std::cerr << "[-] Max file size reached. Force finalizing." << '\n';
         finalizeIncrementalFile(); 
         return;
     }
 
-    ssize_t written = write(out_fd_, data, size);
-    if (written == -1) {
-        perror("[-] Write error");
-        close(out_fd_);
-        out_fd_ = -1;
+    bool accepted;
+    {
+        ScopedTimer timer(Counter::WriteNs);
+        accepted = sink_->write(CarveChunk{&current_, current_.size, data, size});
     }
+    if (accepted) current_.size += size;
+    else fileOpen_ = false;
 }
 
 void FileCarver::finishFile() {
-    if (out_fd_ != -1) {
-        close(out_fd_);
-        out_fd_ = -1;
-        std::cout << " [Saved] File recovery complete." << std::endl;
+    if (fileOpen_) {
+        markDamage();
+        sink_->end(current_);
+        fileOpen_ = false;
+        Metrics::add(Counter::FilesSaved);
+        if (Logger::enabled(LogLevel::Debug)) std::cout << " [Saved] File recovery complete." << '\n';
     }
 }
 
 void FileCarver::recordCandidateEndOfFile() {
-    if (out_fd_ < 0) return;
-    lastValidFooterOffset_ = lseek64(out_fd_, 0, SEEK_CUR);
+    if (!fileOpen_) return;
+    lastValidFooterOffset_ = static_cast<off_t>(current_.size);
 }
 
 void FileCarver::finalizeIncrementalFile() {
-    if (out_fd_ < 0) return;
-
-    if (activeSignature_ && activeSignature_->isIncremental && lastValidFooterOffset_ > 0) {
-        off_t currentSize = lseek(out_fd_, 0, SEEK_CUR);
-        if (currentSize > lastValidFooterOffset_) {
-            if (ftruncate(out_fd_, lastValidFooterOffset_) == -1) {
-                perror("[-] Error truncating file");
-            } else {
-                // std::cout << " [Info] Truncated PDF junk data." << std::endl;
-            }
+    if (fileOpen_) {
+        if (activeSignature_ && activeSignature_->isIncremental && lastValidFooterOffset_ > 0 &&
+            current_.size > static_cast<uint64_t>(lastValidFooterOffset_)) {
+            // Drop junk after the last PDF footer
+            current_.size = static_cast<uint64_t>(lastValidFooterOffset_);
+            sink_->truncate(current_, current_.size);
         }
+        markDamage();
+        sink_->end(current_);
+        fileOpen_ = false;
+        Metrics::add(Counter::FilesSaved);
     }
-
-    close(out_fd_);
-    out_fd_ = -1;
     isExtracting_ = false;
     activeSignature_ = nullptr;
 }
+
+void FileCarver::locatePartition(CarvedFile& file) const {
+    const Partition* p = partitions_.locate(file.offset);
+    file.partition = p ? p->number : 0;
+    file.partitionOffset = p ? file.offset - p->offset : 0;
+}
+
+void FileCarver::markDamage() {
+    if (!tolerant_) return;
+    current_.badBytes = tolerant_->badSectors().overlap(current_.offset, current_.size);
+    if (current_.badBytes > 0) Metrics::add(Counter::DamagedFiles);
+}
+
+void FileCarver::saveBadSectorMap() {
+    if (!tolerant_->badSectors().save(options_.badSectorMapPath)) {
+        perror("[-] Error writing bad sector map");
+    }
+}
+
+void FileCarver::saveCheckpoint(uint64_t currentOffset, bool done) {
+    if (!journal_) return;
+    // The map is written first so a resumed run never re-reads sectors the journal has moved past
+    if (tolerant_ && tolerant_->badSectors().badBytes() > 0) saveBadSectorMap();
+
+    ShardCheckpoint& shard = shards_[shard_];
+    shard.done = done;
+    shard.currentOffset = currentOffset;
+    shard.isExtracting = isExtracting_ && fileOpen_ && activeSignature_;
+    shard.activeExtension = shard.isExtracting ? activeSignature_->extension : "";
+    shard.outFileOffset = shard.isExtracting ? current_.offset : 0;
+    shard.outFileSize = shard.isExtracting ? current_.size : 0;
+    shard.lastValidFooterOffset = shard.isExtracting ? lastValidFooterOffset_ : 0;
+
+    // The journal stores the sink state in its own terms
+    SinkState state;
+    sink_->checkpoint(shard.isExtracting ? &current_ : nullptr, state);
+    shard.outFileName = state.openFile;
+
+    CarveCheckpoint checkpoint;
+    for (const auto& item : state.pending) {
+        checkpoint.pending.push_back(PendingValidation{item.name, item.extension, item.headerOffset});
+    }
+    checkpoint.imagePath = filePath_;
+    checkpoint.imageSize = diskSize_;
+    checkpoint.shards = shards_;
+    journal_->save(checkpoint);
+}
+
+bool FileCarver::restoreCheckpoint() {
+    CarveCheckpoint checkpoint;
+    if (!journal_ || !journal_->load(checkpoint)) {
+        std::cerr << "Error: No usable journal at " << options_.journalPath << std::endl;
+        return false;
+    }
+    // Streams of unknown size can only be matched by path
+    if (checkpoint.imageSize != diskSize_ || (diskSize_ == 0 && checkpoint.imagePath != filePath_)) {
+        std::cerr << "Error: Journal was written for a different image (" << checkpoint.imagePath << ")" << std::endl;
+        return false;
+    }
+
+    // The journal must describe the same selection: every shard is matched by its range
+    for (auto& shard : shards_) {
+        auto it = std::find_if(checkpoint.shards.begin(), checkpoint.shards.end(), [&shard](const ShardCheckpoint& s) {
+            return s.rangeStart == shard.rangeStart && s.rangeEnd == shard.rangeEnd;
+        });
+        if (it == checkpoint.shards.end()) {
+            std::cerr << "Error: Journal has no entry for range " << shard.rangeStart << "-" << shard.rangeEnd << std::endl;
+            return false;
+        }
+        shard = *it;
+    }
+    resumedSinkState_ = SinkState();
+    for (const auto& item : checkpoint.pending) {
+        resumedSinkState_.pending.push_back(SinkPendingItem{item.path, item.extension, item.headerOffset});
+    }
+
+    // Only the shard scanned at checkpoint time can have a file open
+    for (shard_ = 0; shard_ < shards_.size(); ++shard_) {
+        ShardCheckpoint& shard = shards_[shard_];
+        if (!shard.isExtracting) continue;
+
+        activeSignature_ = matcher_->find(shard.activeExtension);
+        if (!activeSignature_) return false;
+
+        current_ = CarvedFile{activeSignature_, shard.outFileOffset, shard.outFileSize};
+        locatePartition(current_);
+        resumedSinkState_.openFile = shard.outFileName;
+        if (sink_->reopen(current_, resumedSinkState_)) {
+            isExtracting_ = true;
+            fileOpen_ = true;
+            lastValidFooterOffset_ = shard.lastValidFooterOffset;
+        } else {
+            // The sink cannot append to the partial file: deliver it again from its header
+            if (Logger::enabled(LogLevel::Info)) {
+                std::cout << "[*] Restarting interrupted file at offset " << shard.outFileOffset << std::endl;
+            }
+            shard.currentOffset = shard.outFileOffset;
+            shard.isExtracting = false;
+            activeSignature_ = nullptr;
+        }
+        break;
+    }
+    shard_ = 0;
+
+    auto next = std::find_if(shards_.begin(), shards_.end(), [](const ShardCheckpoint& s) { return !s.done; });
+    if (next != shards_.end()) {
+        std::cout << "[*] Resuming at offset " << next->currentOffset;
+        if (diskSize_ > 0) std::cout << " of " << diskSize_;
+        std::cout << std::endl;
+    }
+    return true;
+}
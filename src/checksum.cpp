@@ -0,0 +1,19 @@
+#include "checksum.hpp"
+
+uint32_t Checksum::crc32(const uint8_t* data, size_t size) {
+    // Function-local static: the table is built once, thread-safely, on first use
+    static uint32_t table[256];
+    static bool initialized = [] {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,115 @@
+#include "directory_sink.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+
+DirectorySink::DirectorySink(const std::string& outputDir, ValidationMode mode, int minScore, size_t threads,
+                             const GapCarveOptions& gapOptions, std::shared_ptr<ThreadPool> pool)
+    : outputDir_(outputDir.empty() ? "." : outputDir), mode_(mode), minScore_(minScore), threads_(threads),
+      gapOptions_(gapOptions), pool_(std::move(pool)) {}
+
+DirectorySink::~DirectorySink() {
+    if (fd_ != -1) close(fd_);
+}
+
+bool DirectorySink::attach(std::shared_ptr<ImageSource> image) {
+    if (mkdir(outputDir_.c_str(), 0755) == -1 && errno != EEXIST) {
+        perror("Error creating output directory");
+        return false;
+    }
+    if (mode_ != ValidationMode::Off) {
+        validation_ = std::make_unique<ValidationStage>(mode_, minScore_, threads_, std::move(image), gapOptions_, pool_);
+    }
+    return true;
+}
+
+bool DirectorySink::begin(const CarvedFile& file) {
+    path_ = outputDir_ + "/recovered_" + std::to_string(file.offset) + "." + file.signature->extension;
+
+    // O_WRONLY: Open for write only
+    // O_CREAT: Create file if it does not exist
+    // O_TRUNC: Truncate file to zero length if it already exists
+    // 0644: File permissions - owner can read/write, others can read
+    fd_ = open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ == -1) {
+        std::cerr << "Error creating file: " << path_ << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool DirectorySink::write(const CarveChunk& chunk) {
+    size_t total = 0;
+    while (total < chunk.size) {
+        ssize_t written = ::write(fd_, chunk.data + total, chunk.size - total);
+        if (written == -1) {
+            perror("[-] Write error");
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        total += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void DirectorySink::truncate(const CarvedFile& file, uint64_t size) {
+    (void)file;
+    if (ftruncate(fd_, static_cast<off_t>(size)) == -1) {
+        perror("[-] Error truncating file");
+    }
+}
+
+void DirectorySink::end(const CarvedFile& file) {
+    close(fd_);
+    fd_ = -1;
+
+    // Zero-filled sectors would fail validation and get the file discarded; keep it, marked as damaged
+    if (file.badBytes > 0) {
+        std::string damaged = outputDir_ + "/recovered_" + std::to_string(file.offset) + ".damaged." +
+                              file.signature->extension;
+        if (rename(path_.c_str(), damaged.c_str()) == -1) {
+            perror("[-] Error marking damaged file");
+            return;
+        }
+        std::cerr << "[-] " << damaged << ": " << file.badBytes << " unreadable bytes zero-filled" << std::endl;
+        return;
+    }
+    if (validation_) validation_->submit(path_, *file.signature, file.offset);
+}
+
+void DirectorySink::finish() {
+    if (validation_) validation_->drain();
+}
+
+void DirectorySink::checkpoint(const CarvedFile* open, SinkState& state) {
+    if (open && fd_ != -1) {
+        // Only bytes that reached the disk may be recorded as written
+        fdatasync(fd_);
+        state.openFile = path_;
+    }
+    if (validation_) state.pending = validation_->pending();
+}
+
+bool DirectorySink::reopen(const CarvedFile& file, const SinkState& state) {
+    // Reopen the interrupted file and drop anything written after the checkpoint
+    fd_ = open(state.openFile.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd_ == -1 || ftruncate(fd_, static_cast<off_t>(file.size)) == -1) {
+        perror("[-] Error reopening interrupted file");
+        if (fd_ != -1) close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    lseek64(fd_, static_cast<off64_t>(file.size), SEEK_SET);
+    path_ = state.openFile;
+    return true;
+}
+
+void DirectorySink::requeue(const SinkPendingItem& item, const FileSignature& sig) {
+    if (validation_ && access(item.name.c_str(), F_OK) == 0) {
+        validation_->submit(item.name, sig, item.headerOffset);
+    }
+}
@@ -1,5 +1,5 @@
 #include "disk_io.hpp"
-#include <fstream>
+#include "partition_table.hpp"
 #include <iostream>
 #include <vector>
 #include <codecvt>
@@ -79,9 +79,9 @@ NTFSReader::~NTFSReader() {
 }
 
 bool NTFSReader::openImage(const std::string& path) {
-    diskImage.open(path, std::ios::binary);
+    diskImage = ImageSource::open(path);
 
-    if (!diskImage.is_open()) {
+    if (!diskImage) {
         std::cerr << "Error: Failed to open disk image: " << path << std::endl;
         return false;
     }
@@ -89,7 +89,7 @@ bool NTFSReader::openImage(const std::string& path) {
 }
 
 void NTFSReader::closeImage() {
-    if (diskImage.is_open()) { diskImage.close(); }
+    diskImage.reset();
 }
 
 bool NTFSReader::readVBR(NTFS_VBR& vbr) {
@@ -97,20 +97,14 @@ bool NTFSReader::readVBR(NTFS_VBR& vbr) {
 }
 
 bool NTFSReader::readRaw(uint64_t offset, void* buffer, size_t size) {
-    if (!diskImage.is_open()) {
+    if (!diskImage) {
         std::cerr << "Error: Disk image is not open." << std::endl;
         return false;
     }
 
-    diskImage.seekg(offset, std::ios::beg);
-    if (!diskImage.good()) {
-        std::cerr << "Error: Failed to seek to offset " << offset << std::endl;
-        return false;
-    }
+    ssize_t bytesRead = diskImage->readAt(offset, buffer, size);
 
-    diskImage.read(reinterpret_cast<char*>(buffer), size);
-
-    if (diskImage.gcount() != static_cast<std::streamsize>(size)) {
+    if (bytesRead != static_cast<ssize_t>(size)) {
         std::cerr << "Error: Failed to read " << size << " bytes from offset " << offset << std::endl;
         return false;
     }
@@ -119,21 +113,21 @@ bool NTFSReader::readRaw(uint64_t offset, void* buffer, size_t size) {
 }
 
 uint64_t NTFSReader::findNTFSPartitionOffset() {
-    NTFS_MBR mbr;
-
-    if (!readRaw(0, &mbr, sizeof(NTFS_MBR))) return 0;
+    if (!diskImage) {
+        std::cerr << "Error: Disk image is not open." << std::endl;
+        return 0;
+    }
 
-    if (mbr.signature != 0xAA55) {
-        std::cerr << "Error: Invalid MBR signature." << std::endl;
+    // MBR (primary and logical) or GPT; sector size from the table
+    PartitionTable table;
+    if (!table.read(*diskImage)) {
+        std::cerr << "Error: No partition table found." << std::endl;
         return 0;
     }
 
-    // Search for NTFS type in partition table
-    for (int i=0; i<4; ++i) {
-        // 0x07 = NTFS
-        if (mbr.partition[i].fs_type == 0x07) {
-            return (uint64_t)mbr.partition[i].start_lba * 512; // assuming 512 bytes per sector
-        }
+    // Identify NTFS by its boot sector: GPT basic data and MBR type 0x07 also hold exFAT/FAT
+    for (const auto& p : table.partitions()) {
+        if (p.filesystem == "ntfs") return p.offset;
     }
 
     return 0;
@@ -0,0 +1,89 @@
+#include "gap_carver.hpp"
+#include "searcher.hpp"
+#include "validator.hpp"
+#include <algorithm>
+#include <chrono>
+
+GapCarver::GapCarver(std::shared_ptr<ImageSource> image, const GapCarveOptions& options)
+    : image_(std::move(image)), options_(options) {}
+
+bool GapCarver::supports(const std::string& extension) {
+    return extension == "jpg" || extension == "pdf";
+}
+
+GapCarveResult GapCarver::carve(const FileSignature& sig, uint64_t headerOffset, uint64_t validBytes, int minScore) const {
+    GapCarveResult result;
+    const uint64_t cluster = options_.clusterSize;
+    if (!options_.enabled || cluster == 0 || !sig.hasFooter || validBytes <= sig.header.size()) return result;
+
+    // 1. Split points: cluster boundaries at or before the first error, nearest first
+    std::vector<uint64_t> splits; // Relative to headerOffset
+    uint64_t boundary = ((headerOffset + validBytes) / cluster) * cluster;
+    while (boundary > headerOffset + sig.header.size() && splits.size() < options_.maxBackoffClusters) {
+        splits.push_back(boundary - headerOffset);
+        boundary -= cluster;
+    }
+    if (splits.empty()) return result;
+
+    // 2. Load the region holding both fragments and the gap between them in one read
+    uint64_t regionSize = splits.front() + options_.maxGap + options_.maxTail;
+    std::vector<uint8_t> region(regionSize);
+    ssize_t total = image_->readAt(headerOffset, region.data(), region.size());
+    if (total < 0) return result;
+    region.resize(static_cast<size_t>(total));
+    while (!splits.empty() && splits.front() > region.size()) splits.erase(splits.begin());
+    if (splits.empty()) return result;
+
+    // 3. Footers that may terminate the second fragment
+    std::vector<uint64_t> footers;
+    const Searcher::Pattern footerPattern = Searcher::compile(sig.footer);
+    int64_t idx = static_cast<int64_t>(splits.back() + cluster);
+    while ((idx = Searcher::search(region, footerPattern, static_cast<size_t>(idx))) != -1) {
+        footers.push_back(static_cast<uint64_t>(idx));
+        idx += static_cast<int64_t>(sig.footer.size());
+    }
+    if (footers.empty()) return result;
+
+    // 4. Evaluate (gap, split) candidates in a fixed order, smallest gap first; the first success wins.
+    //    This runs inline on the validation worker that owns the file: files are already validated in
+    //    parallel by the pool, so spawning more threads here would only oversubscribe it.
+    const uint64_t numSplits = splits.size();
+    const uint64_t numGaps = options_.maxGap / cluster;
+    const uint64_t totalOrders = numSplits * numGaps;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options_.timeBudgetMs);
+    // The JPEG validator scores 80 for streams it cannot decode (progressive, arithmetic coded), which
+    // says nothing about whether the two fragments fit together: demand a fully decoded scan instead
+    const int acceptScore = sig.extension == "jpg" ? 100 : std::max(minScore, 80);
+
+    uint64_t workUsed = 0;
+    std::vector<uint8_t> candidate;
+    for (uint64_t order = 0; order < totalOrders; ++order) {
+        if (workUsed >= options_.workBudgetBytes) break;
+        if (std::chrono::steady_clock::now() >= deadline) break;
+
+        uint64_t split = splits[order % numSplits];
+        uint64_t gap = (order / numSplits + 1) * cluster;
+        uint64_t tailStart = split + gap;
+
+        auto footer = std::lower_bound(footers.begin(), footers.end(), tailStart);
+        if (footer == footers.end()) continue;
+        uint64_t tailEnd = *footer + sig.footer.size();
+        if (tailEnd - tailStart > options_.maxTail) continue;
+
+        candidate.assign(region.begin(), region.begin() + split);
+        candidate.insert(candidate.end(), region.begin() + tailStart, region.begin() + tailEnd);
+        workUsed += candidate.size();
+
+        ValidationResult check = Validator::validate(sig.extension, candidate.data(), candidate.size());
+        if (check.score < acceptScore) continue;
+
+        result.found = true;
+        result.splitOffset = headerOffset + split;
+        result.gapSize = gap;
+        result.score = check.score;
+        result.data = std::move(candidate);
+        break;
+    }
+
+    return result;
+}
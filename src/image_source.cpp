@@ -0,0 +1,639 @@
+#include "image_source.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#ifdef FILEEDO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef FILEEDO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/* --- Helper --- */
+
+namespace {
+
+// pread until the request is satisfied or the file ends
+ssize_t preadFull(int fd, void* buffer, size_t size, uint64_t offset) {
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = pread64(fd, out + total, size - total, offset + total);
+        if (n < 0) return total > 0 ? static_cast<ssize_t>(total) : -1;
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+uint64_t fdSize(int fd) {
+    off64_t end = lseek64(fd, 0, SEEK_END);
+    return end < 0 ? 0 : static_cast<uint64_t>(end);
+}
+
+// Codec of a gzip or zstd magic at the start of a file; false for anything else
+bool sniffCodec(const uint8_t* magic, ssize_t n, CompressedImageSource::Codec& codec) {
+    if (n >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+        codec = CompressedImageSource::Codec::Gzip;
+        return true;
+    }
+    if (n == 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD) {
+        codec = CompressedImageSource::Codec::Zstd;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+/* --- ImageSource --- */
+
+std::shared_ptr<ImageSource> ImageSource::open(const std::string& path) {
+    if (SegmentedImageSource::isSegmentPath(path)) {
+        auto source = std::make_shared<SegmentedImageSource>(path);
+        if (!source->open()) return nullptr;
+        return source;
+    }
+
+    // Sniff the first bytes for a compression magic
+    uint8_t magic[4] = {0};
+    int fd = ::open(path.c_str(), O_RDONLY | O_LARGEFILE);
+    if (fd < 0) {
+        perror("Error opening file");
+        return nullptr;
+    }
+    ssize_t n = preadFull(fd, magic, sizeof(magic), 0);
+    close(fd);
+
+    CompressedImageSource::Codec codec;
+    if (sniffCodec(magic, n, codec)) {
+#ifndef FILEEDO_HAVE_ZLIB
+        if (codec == CompressedImageSource::Codec::Gzip) {
+            std::cerr << "Error: " << path << " is gzip compressed but FILEEdo was built without zlib" << std::endl;
+            return nullptr;
+        }
+#endif
+#ifndef FILEEDO_HAVE_ZSTD
+        if (codec == CompressedImageSource::Codec::Zstd) {
+            std::cerr << "Error: " << path << " is zstd compressed but FILEEdo was built without libzstd" << std::endl;
+            return nullptr;
+        }
+#endif
+        auto source = std::make_shared<CompressedImageSource>(path, codec);
+        if (!source->open()) return nullptr;
+        return source;
+    }
+
+    auto source = std::make_shared<RawImageSource>(path);
+    if (!source->open()) return nullptr;
+    return source;
+}
+
+bool ImageSource::storedSize(const std::string& path, uint64_t& size) {
+    if (SegmentedImageSource::isSegmentPath(path)) {
+        SegmentedImageSource source(path);
+        if (!source.open()) return false;
+        size = source.size();
+        return true;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_LARGEFILE);
+    if (fd < 0) return false;
+    uint8_t magic[4] = {0};
+    ssize_t n = preadFull(fd, magic, sizeof(magic), 0);
+    CompressedImageSource::Codec codec;
+    bool raw = n >= 0 && !sniffCodec(magic, n, codec);
+    if (raw) size = fdSize(fd);
+    close(fd);
+    return raw;
+}
+
+/* --- RawImageSource --- */
+
+RawImageSource::RawImageSource(const std::string& path) : path_(path) {}
+
+RawImageSource::~RawImageSource() {
+    if (fd_ != -1) close(fd_);
+}
+
+bool RawImageSource::open() {
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_LARGEFILE);
+    if (fd_ < 0) {
+        perror("Error opening file");
+        return false;
+    }
+    size_ = fdSize(fd_); // Works for block devices, unlike st_size
+    return true;
+}
+
+ssize_t RawImageSource::readAt(uint64_t offset, void* buffer, size_t size) {
+    if (offset >= size_) return 0;
+    return preadFull(fd_, buffer, std::min<uint64_t>(size, size_ - offset), offset);
+}
+
+/* --- SegmentedImageSource --- */
+
+SegmentedImageSource::SegmentedImageSource(const std::string& firstPath) : firstPath_(firstPath) {}
+
+SegmentedImageSource::~SegmentedImageSource() {
+    for (const auto& segment : segments_) close(segment.fd);
+}
+
+bool SegmentedImageSource::isSegmentPath(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos || dot + 1 >= path.size() || path.find('/', dot) != std::string::npos) return false;
+    for (size_t i = dot + 1; i < path.size(); ++i) {
+        if (path[i] < '0' || path[i] > '9') return false;
+    }
+    return true;
+}
+
+bool SegmentedImageSource::open() {
+    size_t dot = firstPath_.find_last_of('.');
+    std::string base = firstPath_.substr(0, dot + 1);
+    size_t width = firstPath_.size() - dot - 1;
+    uint64_t number = std::stoull(firstPath_.substr(dot + 1));
+
+    // image.001, image.002, ... until the first missing number (zero padding is kept)
+    while (true) {
+        std::string digits = std::to_string(number);
+        if (digits.size() < width) digits.insert(0, width - digits.size(), '0');
+        std::string path = base + digits;
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_LARGEFILE);
+        if (fd < 0) {
+            if (segments_.empty()) {
+                perror("Error opening file");
+                return false;
+            }
+            break;
+        }
+        uint64_t segmentSize = fdSize(fd);
+        segments_.push_back({fd, size_, segmentSize});
+        size_ += segmentSize;
+        number++;
+    }
+    return true;
+}
+
+ssize_t SegmentedImageSource::readAt(uint64_t offset, void* buffer, size_t size) {
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    size_t total = 0;
+
+    // First segment whose end lies past the offset
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), offset,
+                               [](uint64_t value, const Segment& s) { return value < s.start + s.size; });
+
+    for (; it != segments_.end() && total < size; ++it) {
+        uint64_t pos = offset + total;
+        uint64_t inSegment = pos - it->start;
+        size_t want = static_cast<size_t>(std::min<uint64_t>(size - total, it->size - inSegment));
+        ssize_t n = preadFull(it->fd, out + total, want, inSegment);
+        if (n < 0) return total > 0 ? static_cast<ssize_t>(total) : -1;
+        total += static_cast<size_t>(n);
+        if (static_cast<size_t>(n) < want) break; // Segment shrank underneath us
+    }
+    return static_cast<ssize_t>(total);
+}
+
+std::string SegmentedImageSource::describe() const {
+    return "split image " + firstPath_ + " (" + std::to_string(segments_.size()) + " segments)";
+}
+
+/* --- Decoders --- */
+
+// Streaming decoder positioned at an uncompressed offset
+class CompressedImageSource::Decoder {
+public:
+    virtual ~Decoder() = default;
+
+    /**
+     * @brief Decode the next bytes of the image
+     * @return: Bytes produced (short only at the end), 0 at end, -1 on a corrupt stream
+     */
+    virtual ssize_t read(uint8_t* out, size_t size) = 0;
+
+    uint64_t position() const { return out_; }
+
+    // Seek points found since the last call (only when collecting)
+    std::vector<SeekPoint> takePoints() { return std::move(points_); }
+
+protected:
+    Decoder(int fd, uint64_t span, bool collect) : fd_(fd), span_(span), collect_(collect), in_(64 * 1024) {}
+
+    int fd_;
+    uint64_t span_;                 // Minimum distance between collected points
+    bool collect_;
+    std::vector<uint8_t> in_;       // Compressed input buffer
+    size_t inStart_ = 0;            // Unconsumed input is in_[inStart_, inEnd_)
+    size_t inEnd_ = 0;
+    uint64_t inPos_ = 0;            // File offset just past in_[inEnd_ - 1]
+    uint64_t out_ = 0;              // Uncompressed offset of the next byte
+    uint64_t lastPoint_ = 0;
+    bool done_ = false;
+    std::vector<SeekPoint> points_;
+
+    // Compressed offset of the next unconsumed byte
+    uint64_t consumed() const { return inPos_ - (inEnd_ - inStart_); }
+
+    /**
+     * @brief Make at least `need` unconsumed input bytes available if the file has them
+     * @return: Unconsumed bytes available, -1 on a read error
+     */
+    ssize_t fill(size_t need) {
+        size_t avail = inEnd_ - inStart_;
+        if (avail >= need) return static_cast<ssize_t>(avail);
+        memmove(in_.data(), in_.data() + inStart_, avail);
+        inStart_ = 0;
+        inEnd_ = avail;
+        ssize_t n = preadFull(fd_, in_.data() + inEnd_, in_.size() - inEnd_, inPos_);
+        if (n < 0) return -1;
+        inEnd_ += static_cast<size_t>(n);
+        inPos_ += static_cast<uint64_t>(n);
+        return static_cast<ssize_t>(inEnd_ - inStart_);
+    }
+};
+
+#ifdef FILEEDO_HAVE_ZLIB
+// Gzip (multi-member) decoder; seek points sit on deflate block boundaries, as in zlib's zran example
+class GzipDecoder : public CompressedImageSource::Decoder {
+public:
+    GzipDecoder(int fd, uint64_t span, bool collect) : Decoder(fd, span, collect) {
+        memset(&strm_, 0, sizeof(strm_));
+    }
+
+    ~GzipDecoder() override {
+        if (initialized_) inflateEnd(&strm_);
+    }
+
+    /**
+     * @brief Start at the beginning of the file or resume at a seek point
+     * @return: true on success
+     */
+    bool start(const CompressedImageSource::SeekPoint* point) {
+        if (!point) {
+            initialized_ = inflateInit2(&strm_, 15 + 32) == Z_OK; // gzip header auto-detection
+            return initialized_;
+        }
+
+        // Raw deflate from inside a member: restore the bit offset and the 32 KiB window
+        initialized_ = inflateInit2(&strm_, -15) == Z_OK;
+        if (!initialized_) return false;
+        raw_ = true;
+        inPos_ = point->in - (point->bits ? 1 : 0);
+        out_ = point->out;
+        lastPoint_ = point->out;
+        if (point->bits) {
+            if (fill(1) < 1) return false;
+            int byte = in_[inStart_++];
+            inflatePrime(&strm_, point->bits, byte >> (8 - point->bits));
+        }
+        return inflateSetDictionary(&strm_, point->window.data(), static_cast<uInt>(point->window.size())) == Z_OK;
+    }
+
+    ssize_t read(uint8_t* out, size_t size) override {
+        size_t produced = 0;
+        while (produced < size && !done_) {
+            ssize_t avail = fill(1);
+            if (avail < 0) return produced > 0 ? static_cast<ssize_t>(produced) : -1;
+            if (avail == 0) {
+                done_ = true; // Truncated stream: keep what was decoded
+                break;
+            }
+
+            strm_.next_in = in_.data() + inStart_;
+            strm_.avail_in = static_cast<uInt>(avail);
+            strm_.next_out = out + produced;
+            strm_.avail_out = static_cast<uInt>(std::min<size_t>(size - produced, 1u << 30));
+            uInt outBefore = strm_.avail_out;
+
+            int ret = inflate(&strm_, Z_BLOCK);
+            inStart_ = inEnd_ - strm_.avail_in;
+            size_t n = outBefore - strm_.avail_out;
+            produced += n;
+            out_ += n;
+
+            if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
+                done_ = true;
+                if (produced == 0) return -1;
+                break;
+            }
+            if (ret == Z_BUF_ERROR && n == 0 && strm_.avail_in == static_cast<uInt>(avail)) {
+                done_ = true; // No progress possible
+                break;
+            }
+            if (ret == Z_STREAM_END) {
+                if (!nextMember()) done_ = true;
+                continue;
+            }
+            // End of a deflate block that is not the last one of the member
+            if (collect_ && (strm_.data_type & 128) && !(strm_.data_type & 64) && out_ - lastPoint_ >= span_) {
+                addPoint();
+            }
+        }
+        return static_cast<ssize_t>(produced);
+    }
+
+private:
+    z_stream strm_;
+    bool initialized_ = false;
+    bool raw_ = false;      // Resumed mid-member: headers and trailers are not parsed by zlib
+
+    void addPoint() {
+        CompressedImageSource::SeekPoint point;
+        point.out = out_;
+        point.in = consumed();
+        point.bits = strm_.data_type & 7;
+        point.window.resize(32768);
+        uInt length = static_cast<uInt>(point.window.size());
+        if (inflateGetDictionary(&strm_, point.window.data(), &length) != Z_OK) return;
+        point.window.resize(length);
+        points_.push_back(std::move(point));
+        lastPoint_ = out_;
+    }
+
+    // Continue with a concatenated member, if any
+    bool nextMember() {
+        if (raw_) {
+            // Skip the CRC32 + ISIZE trailer that raw inflate leaves behind
+            if (fill(8) < 8) return false;
+            inStart_ += 8;
+            raw_ = false;
+            if (inflateReset2(&strm_, 15 + 32) != Z_OK) return false;
+        } else if (inflateReset(&strm_) != Z_OK) {
+            return false;
+        }
+        // Trailing zero padding or garbage ends the image
+        if (fill(2) < 2) return false;
+        return in_[inStart_] == 0x1F && in_[inStart_ + 1] == 0x8B;
+    }
+};
+#endif
+
+#ifdef FILEEDO_HAVE_ZSTD
+// Zstd decoder; frames are independent, so seek points sit on frame boundaries
+class ZstdDecoder : public CompressedImageSource::Decoder {
+public:
+    ZstdDecoder(int fd, uint64_t span, bool collect) : Decoder(fd, span, collect), dctx_(ZSTD_createDCtx()) {}
+
+    ~ZstdDecoder() override {
+        ZSTD_freeDCtx(dctx_);
+    }
+
+    bool start(const CompressedImageSource::SeekPoint* point) {
+        if (!dctx_) return false;
+        if (point) {
+            inPos_ = point->in;
+            out_ = point->out;
+            lastPoint_ = point->out;
+        }
+        return true;
+    }
+
+    ssize_t read(uint8_t* out, size_t size) override {
+        size_t produced = 0;
+        while (produced < size && !done_) {
+            ssize_t avail = fill(1);
+            if (avail < 0) return produced > 0 ? static_cast<ssize_t>(produced) : -1;
+            if (avail == 0) {
+                done_ = true;
+                break;
+            }
+
+            ZSTD_inBuffer input = {in_.data() + inStart_, static_cast<size_t>(avail), 0};
+            ZSTD_outBuffer output = {out + produced, size - produced, 0};
+            size_t ret = ZSTD_decompressStream(dctx_, &output, &input);
+            inStart_ += input.pos;
+            produced += output.pos;
+            out_ += output.pos;
+
+            if (ZSTD_isError(ret)) {
+                done_ = true;
+                if (produced == 0) return -1;
+                break;
+            }
+            if (ret == 0 && collect_ && out_ - lastPoint_ >= span_) {
+                CompressedImageSource::SeekPoint point;
+                point.out = out_;
+                point.in = consumed();
+                points_.push_back(std::move(point));
+                lastPoint_ = out_;
+            }
+        }
+        return static_cast<ssize_t>(produced);
+    }
+
+private:
+    ZSTD_DCtx* dctx_;
+};
+#endif
+
+/* --- CompressedImageSource --- */
+
+CompressedImageSource::CompressedImageSource(const std::string& path, Codec codec) : path_(path), codec_(codec) {}
+
+CompressedImageSource::~CompressedImageSource() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    spaceReady_.notify_all();
+    if (producer_.joinable()) producer_.join();
+    randomDecoder_.reset();
+    if (fd_ != -1) close(fd_);
+}
+
+bool CompressedImageSource::open() {
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_LARGEFILE);
+    if (fd_ < 0) {
+        perror("Error opening file");
+        return false;
+    }
+#ifdef FILEEDO_HAVE_ZSTD
+    // zstd can only resume at frame boundaries: a first frame bigger than the index span (typical for
+    // a plain `zstd` run, which writes one frame) leaves backward reads nothing to resume from
+    if (codec_ == Codec::Zstd) {
+        uint8_t header[18] = {0};   // ZSTD_FRAMEHEADERSIZE_MAX
+        ssize_t n = preadFull(fd_, header, sizeof(header), 0);
+        unsigned long long frameSize = n > 0 ? ZSTD_getFrameContentSize(header, static_cast<size_t>(n)) : 0;
+        if (frameSize == ZSTD_CONTENTSIZE_UNKNOWN || (frameSize != ZSTD_CONTENTSIZE_ERROR && frameSize > indexSpan_)) {
+            std::cerr << "[-] " << path_ << " has zstd frames larger than " << (indexSpan_ >> 20)
+                      << " MiB; reads behind the scan re-decode from the start (recompress with pzstd for a seek index)"
+                      << std::endl;
+        }
+    }
+#endif
+    producer_ = std::thread(&CompressedImageSource::produce, this);
+    return true;
+}
+
+std::unique_ptr<CompressedImageSource::Decoder> CompressedImageSource::makeDecoder(const SeekPoint* point,
+                                                                                   bool collectPoints) {
+#ifdef FILEEDO_HAVE_ZLIB
+    if (codec_ == Codec::Gzip) {
+        auto decoder = std::make_unique<GzipDecoder>(fd_, indexSpan_, collectPoints);
+        if (decoder->start(point)) return decoder;
+    }
+#endif
+#ifdef FILEEDO_HAVE_ZSTD
+    if (codec_ == Codec::Zstd) {
+        auto decoder = std::make_unique<ZstdDecoder>(fd_, indexSpan_, collectPoints);
+        if (decoder->start(point)) return decoder;
+    }
+#endif
+    (void)point;
+    (void)collectPoints;
+    return nullptr;
+}
+
+void CompressedImageSource::produce() {
+    std::unique_ptr<Decoder> decoder = makeDecoder(nullptr, true);
+
+    while (decoder) {
+        {
+            // Stay at most readAhead_ bytes in front of the readers
+            std::unique_lock<std::mutex> lock(mutex_);
+            spaceReady_.wait(lock, [this] { return stopping_ || frontier_ < readCursor_ + readAhead_; });
+            if (stopping_) return;
+        }
+
+        Block block;
+        block.offset = decoder->position();
+        block.data.resize(blockSize_);
+        size_t filled = 0;
+        bool failed = false;
+        while (filled < blockSize_) {
+            ssize_t n = decoder->read(block.data.data() + filled, blockSize_ - filled);
+            if (n < 0) failed = true;
+            if (n <= 0) break;
+            filled += static_cast<size_t>(n);
+        }
+        block.data.resize(filled);
+        bool end = filled < blockSize_;
+        std::vector<SeekPoint> points = decoder->takePoints();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& point : points) index_.push_back(std::move(point));
+            if (filled > 0) {
+                frontier_ += filled;
+                blocks_.push_back(std::move(block));
+                if (blocks_.size() > maxBlocks_) blocks_.pop_front();
+            }
+            if (end) {
+                eof_ = true;
+                failed_ = failed;
+            }
+        }
+        dataReady_.notify_all();
+        if (end) return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    eof_ = true;
+    failed_ = true;
+    dataReady_.notify_all();
+}
+
+ssize_t CompressedImageSource::readAt(uint64_t offset, void* buffer, size_t size) {
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    size_t total = 0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (offset + size > readCursor_) {
+        readCursor_ = offset + size;
+        spaceReady_.notify_all();
+    }
+
+    while (total < size) {
+        uint64_t pos = offset + total;
+        if (!blocks_.empty() && pos < blocks_.front().offset) {
+            // Already evicted from the window: decode again from the index
+            lock.unlock();
+            ssize_t n = readBehind(pos, out + total, size - total);
+            if (n < 0) return total > 0 ? static_cast<ssize_t>(total) : -1;
+            return static_cast<ssize_t>(total + n);
+        }
+
+        dataReady_.wait(lock, [this, pos] { return frontier_ > pos || eof_; });
+        if (frontier_ <= pos) {
+            if (failed_ && total == 0) return -1;
+            break;
+        }
+        if (pos < blocks_.front().offset) continue;
+
+        for (const auto& block : blocks_) {
+            if (pos < block.offset || pos >= block.offset + block.data.size()) continue;
+            size_t from = static_cast<size_t>(pos - block.offset);
+            size_t n = std::min(size - total, block.data.size() - from);
+            memcpy(out + total, block.data.data() + from, n);
+            total += n;
+            break;
+        }
+    }
+    return static_cast<ssize_t>(total);
+}
+
+ssize_t CompressedImageSource::readBehind(uint64_t offset, uint8_t* out, size_t size) {
+    std::lock_guard<std::mutex> randomLock(randomMutex_);
+
+    // Nearest seek point at or before the offset
+    SeekPoint point;
+    bool havePoint = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::upper_bound(index_.begin(), index_.end(), offset,
+                                   [](uint64_t value, const SeekPoint& p) { return value < p.out; });
+        if (it != index_.begin()) {
+            point = *(it - 1);
+            havePoint = true;
+        }
+    }
+
+    // Keep decoding with the previous decoder when that is closer than restarting
+    bool reuse = randomDecoder_ && randomDecoder_->position() <= offset &&
+                 (!havePoint || randomDecoder_->position() >= point.out);
+    if (!reuse) {
+        randomDecoder_ = makeDecoder(havePoint ? &point : nullptr, false);
+        if (!randomDecoder_) return -1;
+    }
+
+    std::vector<uint8_t> discard(std::min<uint64_t>(blockSize_, offset - randomDecoder_->position()));
+    while (randomDecoder_->position() < offset) {
+        size_t skip = static_cast<size_t>(std::min<uint64_t>(discard.size(), offset - randomDecoder_->position()));
+        ssize_t n = randomDecoder_->read(discard.data(), skip);
+        if (n <= 0) {
+            randomDecoder_.reset();
+            return n;
+        }
+    }
+
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = randomDecoder_->read(out + total, size - total);
+        if (n < 0) {
+            randomDecoder_.reset();
+            return total > 0 ? static_cast<ssize_t>(total) : -1;
+        }
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+uint64_t CompressedImageSource::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return eof_ && !failed_ ? frontier_ : 0;
+}
+
+bool CompressedImageSource::sizeKnown() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return eof_ && !failed_;
+}
+
+std::string CompressedImageSource::describe() const {
+    return std::string(codec_ == Codec::Gzip ? "gzip" : "zstd") + " image " + path_;
+}
@@ -0,0 +1,126 @@
+#include "journal.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/* --- Helper --- */
+
+namespace {
+
+const char* JOURNAL_MAGIC = "FILEEdo-journal 1";
+
+// Names are written last on their line so they may contain spaces; "-" stands for empty
+std::string encodeName(const std::string& name) {
+    return name.empty() ? "-" : name;
+}
+
+std::string decodeName(std::istream& in) {
+    std::string rest;
+    std::getline(in >> std::ws, rest);
+    return rest == "-" ? "" : rest;
+}
+
+} // namespace
+
+/* --- Method of CarveJournal --- */
+
+CarveJournal::CarveJournal(const std::string& path) : path_(path) {}
+
+bool CarveJournal::save(const CarveCheckpoint& checkpoint) const {
+    std::ostringstream out;
+    out << JOURNAL_MAGIC << '\n';
+    out << "image " << checkpoint.imageSize << ' ' << checkpoint.imagePath << '\n';
+    for (const auto& shard : checkpoint.shards) {
+        out << "shard " << shard.rangeStart << ' ' << shard.rangeEnd << ' ' << shard.done << ' '
+            << shard.currentOffset << ' ' << shard.isExtracting << ' '
+            << encodeName(shard.activeExtension) << ' ' << shard.outFileOffset << ' '
+            << shard.outFileSize << ' ' << shard.lastValidFooterOffset << ' '
+            << encodeName(shard.outFileName) << '\n';
+    }
+    for (const auto& item : checkpoint.pending) {
+        out << "pending " << item.extension << ' ' << item.headerOffset << ' ' << item.path << '\n';
+    }
+    out << "end\n";
+
+    const std::string data = out.str();
+    const std::string tmpPath = path_ + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("[-] Error writing journal");
+        return false;
+    }
+
+    bool ok = write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+    // rename() is atomic: a crash leaves either the previous or the new journal
+    if (!ok || rename(tmpPath.c_str(), path_.c_str()) != 0) {
+        perror("[-] Error writing journal");
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    // The rename itself only becomes durable once the directory entry is on disk
+    if (!syncDirectory(path_)) {
+        perror("[-] Error syncing journal directory");
+        return false;
+    }
+    return true;
+}
+
+bool CarveJournal::syncDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+bool CarveJournal::load(CarveCheckpoint& checkpoint) const {
+    std::ifstream in(path_);
+    if (!in.is_open()) return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != JOURNAL_MAGIC) return false;
+
+    CarveCheckpoint result;
+    bool complete = false;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+
+        if (kind == "image") {
+            fields >> result.imageSize;
+            result.imagePath = decodeName(fields);
+        } else if (kind == "shard") {
+            ShardCheckpoint shard;
+            std::string ext;
+            fields >> shard.rangeStart >> shard.rangeEnd >> shard.done >> shard.currentOffset
+                   >> shard.isExtracting >> ext >> shard.outFileOffset >> shard.outFileSize
+                   >> shard.lastValidFooterOffset;
+            if (!fields) return false;
+            shard.activeExtension = ext == "-" ? "" : ext;
+            shard.outFileName = decodeName(fields);
+            result.shards.push_back(shard);
+        } else if (kind == "pending") {
+            PendingValidation item;
+            fields >> item.extension >> item.headerOffset;
+            if (!fields) return false;
+            item.path = decodeName(fields);
+            result.pending.push_back(item);
+        } else if (kind == "end") {
+            complete = true;
+            break;
+        } else {
+            return false;
+        }
+    }
+
+    if (!complete) return false;
+    checkpoint = result;
+    return true;
+}
@@ -1,16 +1,228 @@
 #include <iostream>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include "batch.hpp"
 #include "carver.hpp"
+#include "logger.hpp"
+
+// "START-END" with decimal or 0x-prefixed hex byte offsets
+static bool parseRange(const std::string& text, ByteRange& range) {
+    size_t dash = text.find('-');
+    if (dash == std::string::npos) return false;
+    try {
+        range.start = std::stoull(text.substr(0, dash), nullptr, 0);
+        range.end = std::stoull(text.substr(dash + 1), nullptr, 0);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return range.start < range.end;
+}
+
+// Decimal number in [minimum, maximum] with nothing after it
+static bool parseNumber(const std::string& text, uint64_t minimum, uint64_t maximum, uint64_t& value) {
+    if (text.empty() || text[0] < '0' || text[0] > '9') return false;   // stoull would accept "-1" and wrap
+    try {
+        size_t used = 0;
+        value = std::stoull(text, &used);
+        if (used != text.size()) return false;
+    } catch (const std::exception&) {
+        return false;
+    }
+    return value >= minimum && value <= maximum;
+}
+
+// Comma separated partition numbers (at least one, each > 0)
+static bool parsePartitions(const std::string& text, std::vector<uint32_t>& partitions) {
+    std::stringstream list(text);
+    std::string number;
+    uint64_t value = 0;
+    while (std::getline(list, number, ',')) {
+        if (!parseNumber(number, 1, UINT32_MAX, value)) return false;
+        partitions.push_back(static_cast<uint32_t>(value));
+    }
+    return !partitions.empty();
+}
+
+static int listPartitions(const std::string& imagePath, uint32_t sectorSize) {
+    auto source = ImageSource::open(imagePath);
+    if (!source) return 1;
+    PartitionTable table;
+    if (!table.read(*source, sectorSize)) {
+        std::cout << "[*] " << imagePath << ": no partition table" << std::endl;
+        return 0;
+    }
+    table.print(std::cout);
+    if (!source->isStream()) {
+        for (const auto& gap : table.unallocated(source->size())) {
+            std::cout << "    unallocated  offset " << gap.start << "  size " << gap.end - gap.start << std::endl;
+        }
+    }
+    return 0;
+}
+
+static void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options] <disk_image_path>..." << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --output-dir=DIR             Where recovered files are written (default: current directory)" << std::endl;
+    std::cout << "  --validate=off|tag|discard   Policy for files failing validation (default: tag)" << std::endl;
+    std::cout << "  --min-score=N                Minimum validation score 0-100 (default: 50)" << std::endl;
+    std::cout << "  --threads=N                  Validation worker threads (default: all cores)" << std::endl;
+    std::cout << "  --cluster-size=N             Cluster size used for gap carving (default: 4096)" << std::endl;
+    std::cout << "  --no-gap-carving             Do not try to reassemble fragmented JPG/PDF files" << std::endl;
+    std::cout << "  --gap-budget-ms=N            Time budget per fragmented file (default: 2000)" << std::endl;
+    std::cout << "  --journal=PATH               Checkpoint journal (default: <output-dir>/FILEEdo.journal)" << std::endl;
+    std::cout << "  --checkpoint-mb=N            MiB scanned between checkpoints, 0 disables (default: 256)" << std::endl;
+    std::cout << "  --resume                     Continue an interrupted run from the journal" << std::endl;
+    std::cout << "  --progress=PATH|-            Write JSON-lines progress records (\"-\" = stderr)" << std::endl;
+    std::cout << "  --progress-interval-ms=N     Time between progress records (default: 1000)" << std::endl;
+    std::cout << "  --log-level=quiet|info|debug Console verbosity (default: info)" << std::endl;
+    std::cout << "  --sector-size=N              Logical sector size, a power of two >= 512 (default: from the partition table, else 512)" << std::endl;
+    std::cout << "  --max-skip-mb=N              Largest jump over a damaged area in MiB (default: 4)" << std::endl;
+    std::cout << "  --stop-on-read-error         End the scan at the first unreadable sector" << std::endl;
+    std::cout << "Scan selection (default: whole image):" << std::endl;
+    std::cout << "  --list-partitions            Print the MBR/GPT partition table and exit" << std::endl;
+    std::cout << "  --partitions=N[,N...]        Carve only these partitions" << std::endl;
+    std::cout << "  --range=START-END            Carve only image bytes [START, END) (repeatable, 0x for hex)" << std::endl;
+    std::cout << "  --unallocated                Carve the space outside every partition" << std::endl;
+    std::cout << "Batch mode (several images or --batch):" << std::endl;
+    std::cout << "  --batch=LIST                 File with one image path per line" << std::endl;
+    std::cout << "  --parallel=N                 Images scanned at once (default: all cores)" << std::endl;
+    std::cout << "  --per-device=N               Images scanned at once per physical disk (default: 1)" << std::endl;
+    std::cout << "  --manifest=PATH              CSV of recovered files with image and partition offsets" << std::endl;
+    std::cout << "                               (batch default: <output-dir>/manifest.csv, single image: off)" << std::endl;
+    std::cout << "Images: raw file or device, first split segment (disk.001), gzip or zstd compressed image" << std::endl;
+    std::cout << "Example: " << prog << " disk.img" << std::endl;
+}
+
+static int usageError(const char* prog) {
+    printUsage(prog);
+    return 1;
+}
 
 int main(int argc, char* argv[]) {
+    BatchOptions batch;
+    CarverOptions& options = batch.carver;
+    std::vector<std::string> imagePaths;
+    bool batchMode = false;
+    bool listOnly = false;
+    const uint64_t maxMiB = UINT64_MAX >> 20;       // Largest MiB count that still fits in bytes
+    uint64_t value = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto number = [&arg](const char* prefix, uint64_t minimum, uint64_t maximum, uint64_t& out) {
+            return parseNumber(arg.substr(strlen(prefix)), minimum, maximum, out);
+        };
+        if (arg.rfind("--output-dir=", 0) == 0) {
+            options.outputDir = arg.substr(strlen("--output-dir="));
+        } else if (arg.rfind("--validate=", 0) == 0) {
+            std::string mode = arg.substr(strlen("--validate="));
+            if (mode == "off") options.validation = ValidationMode::Off;
+            else if (mode == "tag") options.validation = ValidationMode::Tag;
+            else if (mode == "discard") options.validation = ValidationMode::Discard;
+            else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--min-score=", 0) == 0) {
+            if (!number("--min-score=", 0, 100, value)) return usageError(argv[0]);
+            options.minScore = static_cast<int>(value);
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            if (!number("--threads=", 0, 4096, value)) return usageError(argv[0]);
+            options.workerThreads = static_cast<size_t>(value);
+        } else if (arg.rfind("--cluster-size=", 0) == 0) {
+            if (!number("--cluster-size=", 1, UINT32_MAX, value)) return usageError(argv[0]);
+            options.gap.clusterSize = static_cast<uint32_t>(value);
+        } else if (arg == "--no-gap-carving") {
+            options.gap.enabled = false;
+        } else if (arg.rfind("--gap-budget-ms=", 0) == 0) {
+            if (!number("--gap-budget-ms=", 0, UINT32_MAX, value)) return usageError(argv[0]);
+            options.gap.timeBudgetMs = static_cast<uint32_t>(value);
+        } else if (arg.rfind("--journal=", 0) == 0) {
+            options.journalPath = arg.substr(strlen("--journal="));
+        } else if (arg.rfind("--checkpoint-mb=", 0) == 0) {
+            if (!number("--checkpoint-mb=", 0, maxMiB, value)) return usageError(argv[0]);
+            options.checkpointInterval = value * 1024 * 1024;
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg.rfind("--progress=", 0) == 0) {
+            options.progressPath = arg.substr(strlen("--progress="));
+        } else if (arg.rfind("--progress-interval-ms=", 0) == 0) {
+            if (!number("--progress-interval-ms=", 0, UINT32_MAX, value)) return usageError(argv[0]);
+            options.progressIntervalMs = static_cast<uint32_t>(value);
+        } else if (arg.rfind("--log-level=", 0) == 0) {
+            LogLevel level;
+            if (!Logger::parse(arg.substr(strlen("--log-level=")), level)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            Logger::setLevel(level);
+        } else if (arg.rfind("--sector-size=", 0) == 0) {
+            // A power of two from 512 bytes up, like every real logical sector size
+            if (!number("--sector-size=", 512, 1U << 16, value) || (value & (value - 1)) != 0) return usageError(argv[0]);
+            options.sectorSize = static_cast<uint32_t>(value);
+        } else if (arg.rfind("--max-skip-mb=", 0) == 0) {
+            if (!number("--max-skip-mb=", 0, maxMiB, value)) return usageError(argv[0]);
+            options.maxBadSkip = value * 1024 * 1024;
+        } else if (arg == "--stop-on-read-error") {
+            options.tolerateReadErrors = false;
+        } else if (arg == "--list-partitions") {
+            listOnly = true;
+        } else if (arg.rfind("--partitions=", 0) == 0) {
+            if (!parsePartitions(arg.substr(strlen("--partitions=")), options.partitions)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.rfind("--range=", 0) == 0) {
+            ByteRange range;
+            if (!parseRange(arg.substr(strlen("--range=")), range)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            options.ranges.push_back(range);
+        } else if (arg == "--unallocated") {
+            options.unallocated = true;
+        } else if (arg.rfind("--batch=", 0) == 0) {
+            if (!BatchCarver::readList(arg.substr(strlen("--batch=")), imagePaths)) return 1;
+            batchMode = true;
+        } else if (arg.rfind("--parallel=", 0) == 0) {
+            if (!number("--parallel=", 0, 4096, value)) return usageError(argv[0]);
+            batch.parallelScans = static_cast<size_t>(value);
+        } else if (arg.rfind("--per-device=", 0) == 0) {
+            if (!number("--per-device=", 1, 4096, value)) return usageError(argv[0]);
+            batch.perDeviceScans = static_cast<size_t>(value);
+        } else if (arg.rfind("--manifest=", 0) == 0) {
+            batch.manifestPath = arg.substr(strlen("--manifest="));
+        } else if (arg.rfind("--", 0) == 0) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            imagePaths.push_back(arg);
+        }
+    }
+
     // check for correct number of arguments
-    if (argc != 2) {
-        std::cout << "Usage: " << argv[0] << " <disk_image_path>" << std::endl;
-        std::cout << "Example: " << argv[0] << " disk.img" << std::endl;
+    if (imagePaths.empty()) {
+        printUsage(argv[0]);
         return 1;
     }
 
-    std::string imagePath = argv[1];
-    FileCarver carver(imagePath);
+    if (listOnly) {
+        int status = 0;
+        for (const auto& path : imagePaths) status |= listPartitions(path, options.sectorSize);
+        return status;
+    }
+
+    if (batchMode || imagePaths.size() > 1) {
+        std::cout << "[*] Batch carving " << imagePaths.size() << " images..." << std::endl;
+        size_t failed = BatchCarver(imagePaths, batch).run();
+        std::cout << "[*] Batch completed (" << failed << " failed)." << std::endl;
+        return failed == 0 ? 0 : 1;
+    }
+
+    const std::string& imagePath = imagePaths.front();
+    FileCarver carver(imagePath, options);
 
     std::cout << "[*] Initializing File Carver for: " << imagePath << "..." << std::endl;
     if (!carver.initialize()) {
@@ -20,6 +232,13 @@ int main(int argc, char* argv[]) {
     std::cout << "[*] Starting file carving process. This may take a while..." << std::endl;
     carver.startCarving();
 
+    if (!batch.manifestPath.empty()) {
+        if (!BatchCarver::writeImageManifest(imagePath, options.outputDir, options.validation, carver.partitionTable(),
+                                             batch.manifestPath)) {
+            std::cerr << "Error: Failed to write manifest " << batch.manifestPath << std::endl;
+        }
+    }
+
     std::cout << "[*] File carving completed." << std::endl;
     return 0;
 }
@@ -0,0 +1,51 @@
+#include "metrics.hpp"
+
+Metrics& Metrics::instance() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::ThreadSlot& Metrics::local() {
+    thread_local ThreadSlot* slot = instance().registerSlot();
+    return *slot;
+}
+
+Metrics::ThreadSlot* Metrics::registerSlot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.push_back(std::make_unique<ThreadSlot>());
+    return slots_.back().get();
+}
+
+void Metrics::setTypeNames(const std::vector<std::string>& names) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    typeNames_ = names;
+    if (typeNames_.size() > MAX_TYPES) typeNames_.resize(MAX_TYPES);
+}
+
+std::vector<std::string> Metrics::typeNames() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return typeNames_;
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricsSnapshot result;
+    result.candidates.assign(typeNames_.size(), 0);
+    for (const auto& slot : slots_) {
+        for (size_t i = 0; i < result.values.size(); ++i) {
+            result.values[i] += slot->values[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < result.candidates.size(); ++i) {
+            result.candidates[i] += slot->candidates[i].load(std::memory_order_relaxed);
+        }
+    }
+    return result;
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& slot : slots_) {
+        for (auto& value : slot->values) value.store(0, std::memory_order_relaxed);
+        for (auto& value : slot->candidates) value.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,334 @@
+#include "partition_table.hpp"
+#include "checksum.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <set>
+
+/* --- Helper --- */
+
+namespace {
+
+const uint32_t SECTOR_SIZES[] = {512, 4096, 1024, 2048};
+const uint32_t MAX_GPT_ENTRIES = 1024;
+const uint32_t MAX_GPT_ENTRY_SIZE = 4096;           // Entries are 128 * 2^n bytes; real tables use 128
+const uint64_t MAX_GPT_ENTRY_ARRAY = 1024 * 1024;   // Largest entry array read (the usual one is 16 KiB)
+const uint32_t MAX_LOGICAL_PARTITIONS = 256;
+
+bool readFull(ImageSource& image, uint64_t offset, void* buffer, size_t size) {
+    return image.readAt(offset, buffer, size) == static_cast<ssize_t>(size);
+}
+
+bool isExtended(uint8_t type) {
+    return type == 0x05 || type == 0x0F || type == 0x85;
+}
+
+const char* mbrTypeName(uint8_t type) {
+    switch (type) {
+        case 0x01: return "fat12";
+        case 0x04: case 0x06: case 0x0E: return "fat16";
+        case 0x07: return "ntfs/exfat";
+        case 0x0B: case 0x0C: return "fat32";
+        case 0x27: return "windows-recovery";
+        case 0x82: return "linux-swap";
+        case 0x83: return "linux";
+        case 0x8E: return "linux-lvm";
+        case 0xA5: return "freebsd";
+        case 0xAF: return "hfs+";
+        case 0xEF: return "efi";
+        case 0xFD: return "linux-raid";
+        default: return "unknown";
+    }
+}
+
+// Mixed-endian GUID text form: the first three fields are stored little-endian
+std::string guidText(const uint8_t* g) {
+    char text[40];
+    snprintf(text, sizeof(text), "%02X%02X%02X%02X-%02X%02X-%02X%02X-%02X%02X-%02X%02X%02X%02X%02X%02X",
+             g[3], g[2], g[1], g[0], g[5], g[4], g[7], g[6], g[8], g[9], g[10], g[11], g[12], g[13], g[14], g[15]);
+    return text;
+}
+
+const char* gptTypeName(const std::string& guid) {
+    static const struct { const char* guid; const char* name; } types[] = {
+        {"C12A7328-F81F-11D2-BA4B-00A0C93EC93B", "efi"},
+        {"E3C9E316-0B5C-4DB8-817D-F92DF00215AE", "microsoft-reserved"},
+        {"EBD0A0A2-B9E5-4433-87C0-68B6B72699C7", "microsoft-basic-data"},
+        {"DE94BBA4-06D1-4D40-A16A-BFD50179D6AC", "windows-recovery"},
+        {"0FC63DAF-8483-4772-8E79-3D69D8477DE4", "linux"},
+        {"0657FD6D-A4AB-43C4-84E5-0933C84B4F4F", "linux-swap"},
+        {"E6D6D379-F507-44C2-A23C-238F2A3DF928", "linux-lvm"},
+        {"A19D880F-05FC-4D3B-A006-743F0F84911E", "linux-raid"},
+        {"4F68BCE3-E8CD-4DB1-96E7-FBCAF984B709", "linux-root-x86-64"},
+        {"933AC7E1-2EB4-4F13-B844-0E14E2AEF915", "linux-home"},
+        {"48465300-0000-11AA-AA11-00306543ECAC", "hfs+"},
+        {"7C3457EF-0000-11AA-AA11-00306543ECAC", "apfs"},
+        {"21686148-6449-6E6F-744E-656564454649", "bios-boot"},
+    };
+    for (const auto& t : types) {
+        if (guid == t.guid) return t.name;
+    }
+    return "unknown";
+}
+
+// GPT names are UTF-16LE; surrogate pairs are rare enough in partition names to be dropped
+std::string utf16ToUtf8(const uint16_t* name, size_t count) {
+    std::string out;
+    for (size_t i = 0; i < count && name[i] != 0; ++i) {
+        uint16_t c = name[i];
+        if (c < 0x80) {
+            out += static_cast<char>(c);
+        } else if (c < 0x800) {
+            out += static_cast<char>(0xC0 | (c >> 6));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0xD800 || c > 0xDFFF) {
+            out += static_cast<char>(0xE0 | (c >> 12));
+            out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+/* --- Method of PartitionTable --- */
+
+bool PartitionTable::read(ImageSource& image, uint32_t sectorSize, bool probeFilesystems) {
+    scheme_ = Scheme::None;
+    sectorSize_ = sectorSize ? sectorSize : 512;
+    probeFilesystems_ = probeFilesystems;
+    partitions_.clear();
+
+    NTFS_MBR mbr;
+    bool haveMBR = readFull(image, 0, &mbr, sizeof(NTFS_MBR)) && mbr.signature == 0xAA55;
+
+    // GPT: the header sits in LBA 1, so its position reveals the sector size
+    for (uint32_t ss : SECTOR_SIZES) {
+        if (sectorSize && ss != sectorSize) continue;
+        if (readGPT(image, 1, ss)) return true;
+    }
+    // Damaged primary GPT: fall back to the backup header in the last LBA
+    if (!image.isStream()) {
+        for (uint32_t ss : SECTOR_SIZES) {
+            if (sectorSize && ss != sectorSize) continue;
+            if (image.size() / ss < 2) continue;
+            if (readGPT(image, image.size() / ss - 1, ss)) {
+                std::cerr << "[-] Primary GPT is damaged, using the backup header" << std::endl;
+                return true;
+            }
+        }
+    }
+
+    if (!haveMBR) return false;
+    // A volume boot sector also ends in 0x55AA: an unpartitioned ("superfloppy") file system
+    if (!detectFilesystem(image, 0).empty()) return false;
+    for (int i = 0; i < 4; ++i) {
+        if (mbr.partition[i].boot_flag != 0x00 && mbr.partition[i].boot_flag != 0x80) return false;
+    }
+    // Detecting 4Kn needs the partitions' boot sectors; without probing, MBR LBAs count 512-byte sectors
+    uint32_t ss = sectorSize ? sectorSize : (probeFilesystems ? detectMBRSectorSize(image, mbr) : 512);
+    readMBR(image, mbr, ss);
+    if (partitions_.empty()) return false;
+
+    scheme_ = Scheme::MBR;
+    sectorSize_ = ss;
+    return true;
+}
+
+const char* PartitionTable::schemeName() const {
+    switch (scheme_) {
+        case Scheme::MBR: return "mbr";
+        case Scheme::GPT: return "gpt";
+        default: return "none";
+    }
+}
+
+const Partition* PartitionTable::find(uint32_t number) const {
+    for (const auto& p : partitions_) {
+        if (p.number == number) return &p;
+    }
+    return nullptr;
+}
+
+const Partition* PartitionTable::locate(uint64_t offset) const {
+    for (const auto& p : partitions_) {
+        if (offset >= p.offset && offset - p.offset < p.size) return &p;
+    }
+    return nullptr;
+}
+
+std::vector<ByteRange> PartitionTable::unallocated(uint64_t diskSize) const {
+    std::vector<Partition> sorted = partitions_;
+    std::sort(sorted.begin(), sorted.end(), [](const Partition& a, const Partition& b) { return a.offset < b.offset; });
+
+    std::vector<ByteRange> gaps;
+    uint64_t pos = 0;
+    for (const auto& p : sorted) {
+        if (p.offset > pos) gaps.push_back(ByteRange{pos, std::min(p.offset, diskSize)});
+        pos = std::max(pos, p.offset + p.size);
+        if (pos >= diskSize) break;
+    }
+    if (pos < diskSize) gaps.push_back(ByteRange{pos, diskSize});
+
+    gaps.erase(std::remove_if(gaps.begin(), gaps.end(), [](const ByteRange& r) { return r.start >= r.end; }),
+               gaps.end());
+    return gaps;
+}
+
+void PartitionTable::print(std::ostream& out) const {
+    out << "[*] Partition table: " << schemeName() << ", " << sectorSize_ << "-byte sectors" << std::endl;
+    for (const auto& p : partitions_) {
+        out << "    #" << p.number << "  offset " << p.offset << "  size " << p.size << "  type " << p.typeName
+            << " (" << p.type << ")";
+        if (!p.filesystem.empty()) out << "  fs " << p.filesystem;
+        if (!p.name.empty()) out << "  \"" << p.name << "\"";
+        out << std::endl;
+    }
+}
+
+bool PartitionTable::readGPT(ImageSource& image, uint64_t lba, uint32_t sectorSize) {
+    GPT_HEADER header;
+    if (!readFull(image, lba * sectorSize, &header, sizeof(GPT_HEADER))) return false;
+    if (memcmp(header.signature, "EFI PART", 8) != 0 || header.current_lba != lba) return false;
+    if (header.header_size < sizeof(GPT_HEADER) || header.header_size > sectorSize) return false;
+
+    // The CRC covers header_size bytes with the CRC field itself zeroed
+    std::vector<uint8_t> raw(header.header_size);
+    if (!readFull(image, lba * sectorSize, raw.data(), raw.size())) return false;
+    memset(raw.data() + offsetof(GPT_HEADER, header_crc32), 0, sizeof(uint32_t));
+    if (Checksum::crc32(raw.data(), raw.size()) != header.header_crc32) return false;
+
+    // Bound the entry array before allocating it: the header is trusted only as far as its CRC goes
+    if (header.entry_size < sizeof(GPT_ENTRY) || header.entry_size % 128 != 0 ||
+        header.entry_size > MAX_GPT_ENTRY_SIZE || header.num_entries > MAX_GPT_ENTRIES) {
+        return false;
+    }
+    if (static_cast<uint64_t>(header.num_entries) * header.entry_size > MAX_GPT_ENTRY_ARRAY) return false;
+    std::vector<uint8_t> entries(static_cast<size_t>(header.num_entries) * header.entry_size);
+    if (!readFull(image, header.entries_lba * sectorSize, entries.data(), entries.size())) return false;
+    if (Checksum::crc32(entries.data(), entries.size()) != header.entries_crc32) return false;
+
+    std::vector<Partition> found;
+    for (uint32_t i = 0; i < header.num_entries; ++i) {
+        GPT_ENTRY entry;
+        memcpy(&entry, entries.data() + static_cast<size_t>(i) * header.entry_size, sizeof(GPT_ENTRY));
+        static const uint8_t unused[16] = {0};
+        if (memcmp(entry.type_guid, unused, sizeof(unused)) == 0) continue;
+        if (entry.last_lba < entry.first_lba) continue;
+
+        Partition p;
+        p.number = i + 1;
+        p.offset = entry.first_lba * sectorSize;
+        p.size = (entry.last_lba - entry.first_lba + 1) * sectorSize;
+        p.type = guidText(entry.type_guid);
+        p.typeName = gptTypeName(p.type);
+        p.name = utf16ToUtf8(entry.name, sizeof(entry.name) / sizeof(entry.name[0]));
+        if (probeFilesystems_) p.filesystem = detectFilesystem(image, p.offset);
+        found.push_back(p);
+    }
+
+    scheme_ = Scheme::GPT;
+    sectorSize_ = sectorSize;
+    partitions_ = found;
+    return true;
+}
+
+void PartitionTable::readMBR(ImageSource& image, const NTFS_MBR& mbr, uint32_t sectorSize) {
+    for (int i = 0; i < 4; ++i) {
+        const MBR_PTE& pte = mbr.partition[i];
+        if (pte.fs_type == 0x00 || pte.total_sectors == 0) continue;
+        if (pte.fs_type == 0xEE) continue;   // GPT protective entry without a readable GPT
+
+        if (isExtended(pte.fs_type)) {
+            readLogical(image, pte.start_lba, sectorSize);
+            continue;
+        }
+        Partition p;
+        p.number = static_cast<uint32_t>(i + 1);
+        p.offset = static_cast<uint64_t>(pte.start_lba) * sectorSize;
+        p.size = static_cast<uint64_t>(pte.total_sectors) * sectorSize;
+        char type[8];
+        snprintf(type, sizeof(type), "0x%02X", pte.fs_type);
+        p.type = type;
+        p.typeName = mbrTypeName(pte.fs_type);
+        if (probeFilesystems_) p.filesystem = detectFilesystem(image, p.offset);
+        partitions_.push_back(p);
+    }
+    std::sort(partitions_.begin(), partitions_.end(),
+              [](const Partition& a, const Partition& b) { return a.number < b.number; });
+}
+
+void PartitionTable::readLogical(ImageSource& image, uint64_t extendedLba, uint32_t sectorSize) {
+    // Each EBR holds one logical partition (relative to the EBR) and a link to the next EBR
+    // (relative to the start of the extended partition)
+    uint32_t number = 5;
+    uint64_t ebrLba = extendedLba;
+    std::set<uint64_t> visited;
+
+    while (number < 5 + MAX_LOGICAL_PARTITIONS && visited.insert(ebrLba).second) {
+        NTFS_MBR ebr;
+        if (!readFull(image, ebrLba * sectorSize, &ebr, sizeof(NTFS_MBR)) || ebr.signature != 0xAA55) {
+            std::cerr << "[-] Broken extended partition chain at LBA " << ebrLba << std::endl;
+            return;
+        }
+
+        const MBR_PTE& logical = ebr.partition[0];
+        if (logical.fs_type != 0x00 && logical.total_sectors != 0) {
+            Partition p;
+            p.number = number++;
+            p.offset = (ebrLba + logical.start_lba) * sectorSize;
+            p.size = static_cast<uint64_t>(logical.total_sectors) * sectorSize;
+            char type[8];
+            snprintf(type, sizeof(type), "0x%02X", logical.fs_type);
+            p.type = type;
+            p.typeName = mbrTypeName(logical.fs_type);
+            if (probeFilesystems_) p.filesystem = detectFilesystem(image, p.offset);
+            partitions_.push_back(p);
+        }
+
+        const MBR_PTE& link = ebr.partition[1];
+        if (!isExtended(link.fs_type) || link.start_lba == 0) return;
+        ebrLba = extendedLba + link.start_lba;
+    }
+}
+
+uint32_t PartitionTable::detectMBRSectorSize(ImageSource& image, const NTFS_MBR& mbr) {
+    // 4Kn disks keep the MBR layout but count LBAs in 4096-byte sectors: pick the size under which
+    // the partitions start with a boot sector or a known file system
+    for (uint32_t ss : SECTOR_SIZES) {
+        for (int i = 0; i < 4; ++i) {
+            const MBR_PTE& pte = mbr.partition[i];
+            if (pte.fs_type == 0x00 || pte.fs_type == 0xEE || pte.total_sectors == 0) continue;
+            uint64_t offset = static_cast<uint64_t>(pte.start_lba) * ss;
+            if (!image.isStream() && offset >= image.size()) continue;
+
+            uint16_t signature = 0;
+            if (isExtended(pte.fs_type)) {
+                if (readFull(image, offset + 510, &signature, 2) && signature == 0xAA55) return ss;
+            } else if (!detectFilesystem(image, offset).empty()) {
+                return ss;
+            }
+        }
+    }
+    return 512;
+}
+
+std::string PartitionTable::detectFilesystem(ImageSource& image, uint64_t offset) {
+    uint8_t sector[4096];
+    if (!readFull(image, offset, sector, sizeof(sector))) return "";
+
+    if (memcmp(sector + 3, "NTFS    ", 8) == 0) return "ntfs";
+    if (memcmp(sector + 3, "EXFAT   ", 8) == 0) return "exfat";
+    if (memcmp(sector + 82, "FAT32   ", 8) == 0) return "fat32";
+    if (memcmp(sector + 54, "FAT12   ", 8) == 0 || memcmp(sector + 54, "FAT16   ", 8) == 0) return "fat";
+    if (memcmp(sector, "XFSB", 4) == 0) return "xfs";
+    if (memcmp(sector, "LUKS\xBA\xBE", 6) == 0) return "luks";
+    if (sector[1024 + 56] == 0x53 && sector[1024 + 57] == 0xEF) return "ext";
+    if (memcmp(sector + 1024, "H+", 2) == 0 || memcmp(sector + 1024, "HX", 2) == 0) return "hfs+";
+    if (memcmp(sector + 32, "NXSB", 4) == 0) return "apfs";
+    if (memcmp(sector + 4086, "SWAPSPACE2", 10) == 0) return "swap";
+    return "";
+}
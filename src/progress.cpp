@@ -0,0 +1,128 @@
+#include "progress.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string formatNumber(double value) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << value;
+    return out.str();
+}
+
+} // namespace
+
+ProgressReporter::ProgressReporter(const std::string& path, uint32_t intervalMs, uint64_t totalBytes)
+    : path_(path), intervalMs_(intervalMs == 0 ? 1000 : intervalMs), totalBytes_(totalBytes) {}
+
+ProgressReporter::~ProgressReporter() {
+    finish();
+}
+
+void ProgressReporter::start() {
+    startTime_ = std::chrono::steady_clock::now();
+    if (path_.empty()) return;
+
+    out_ = path_ == "-" ? stderr : fopen(path_.c_str(), "w");
+    if (!out_) {
+        perror("[-] Error opening progress output");
+        return;
+    }
+    thread_ = std::thread(&ProgressReporter::run, this);
+}
+
+void ProgressReporter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+        finished_ = true;
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+
+    MetricsSnapshot snapshot = Metrics::instance().snapshot();
+    if (out_) {
+        std::string record = formatRecord(snapshot, true);
+        fputs(record.c_str(), out_);
+        fflush(out_);
+        if (out_ != stderr) fclose(out_);
+        out_ = nullptr;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+    double mbps = seconds > 0 ? snapshot.get(Counter::BytesRead) / seconds / (1024.0 * 1024.0) : 0.0;
+    std::vector<std::string> types = Metrics::instance().typeNames();
+
+    std::ostringstream report;
+    report << "[*] Report: read " << snapshot.get(Counter::BytesRead) << " bytes in " << std::fixed
+           << std::setprecision(1) << seconds << " s (" << mbps << " MiB/s), matcher "
+           << snapshot.get(Counter::MatcherNs) / 1000000 << " ms, write "
+           << snapshot.get(Counter::WriteNs) / 1000000 << " ms" << '\n';
+    report << "[*] Report: candidates";
+    for (size_t i = 0; i < types.size() && i < snapshot.candidates.size(); ++i) {
+        report << ' ' << types[i] << '=' << snapshot.candidates[i];
+    }
+    report << ", collisions " << snapshot.get(Counter::Collisions) << ", cap hits "
+           << snapshot.get(Counter::CapHits) << ", skipped " << snapshot.get(Counter::SkippedBytes) << " bytes, unreadable "
+           << snapshot.get(Counter::BadBytes) << " bytes (" << snapshot.get(Counter::DamagedFiles) << " damaged files)";
+    std::cout << report.str() << std::endl;
+}
+
+void ProgressReporter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(intervalMs_));
+        if (stopping_) break;
+
+        lock.unlock();
+        std::string record = formatRecord(Metrics::instance().snapshot(), false);
+        fputs(record.c_str(), out_);
+        fflush(out_);
+        lock.lock();
+    }
+}
+
+std::string ProgressReporter::formatRecord(const MetricsSnapshot& snapshot, bool final) const {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime_).count();
+    uint64_t bytesRead = snapshot.get(Counter::BytesRead);
+    double rate = seconds > 0 ? bytesRead / seconds : 0.0;
+    // bytes_read includes the small re-read overlap between buffers, so clamp the percentage
+    double percent = totalBytes_ > 0 ? std::min(100.0, 100.0 * bytesRead / totalBytes_) : 100.0;
+    double eta = (rate > 0 && totalBytes_ > bytesRead) ? (totalBytes_ - bytesRead) / rate : 0.0;
+    bool known = totalBytes_ > 0 || final; // Compressed streams learn their size only at the end
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "{\"final\":" << (final ? "true" : "false")
+        << ",\"elapsed_s\":" << seconds
+        << ",\"bytes_total\":" << totalBytes_
+        << ",\"bytes_read\":" << bytesRead
+        << ",\"bytes_scanned\":" << snapshot.get(Counter::BytesScanned)
+        << ",\"percent\":" << (known ? formatNumber(percent) : "null")
+        << ",\"read_mib_s\":" << rate / (1024.0 * 1024.0)
+        << ",\"eta_s\":" << (known ? formatNumber(eta) : "null")
+        << ",\"matcher_ms\":" << snapshot.get(Counter::MatcherNs) / 1e6
+        << ",\"write_ms\":" << snapshot.get(Counter::WriteNs) / 1e6
+        << ",\"candidates\":{";
+
+    std::vector<std::string> types = Metrics::instance().typeNames();
+    for (size_t i = 0; i < types.size() && i < snapshot.candidates.size(); ++i) {
+        if (i) out << ',';
+        out << '"' << types[i] << "\":" << snapshot.candidates[i];
+    }
+
+    out << "},\"collisions\":" << snapshot.get(Counter::Collisions)
+        << ",\"cap_hits\":" << snapshot.get(Counter::CapHits)
+        << ",\"skipped_bytes\":" << snapshot.get(Counter::SkippedBytes)
+        << ",\"files_saved\":" << snapshot.get(Counter::FilesSaved)
+        << ",\"accepted\":" << snapshot.get(Counter::Accepted)
+        << ",\"rejected\":" << snapshot.get(Counter::Rejected)
+        << ",\"reassembled\":" << snapshot.get(Counter::Reassembled)
+        << ",\"bad_bytes\":" << snapshot.get(Counter::BadBytes)
+        << ",\"damaged_files\":" << snapshot.get(Counter::DamagedFiles)
+        << "}\n";
+    return out.str();
+}
@@ -1,23 +1,37 @@
 #include "searcher.hpp"
 #include <algorithm>
 
-int64_t Searcher::search(const std::vector<uint8_t>& haystack,
-                         const std::vector<uint8_t>& needle,
-                         size_t startOffset) {
-    size_t n = haystack.size();
+Searcher::Pattern Searcher::compile(const std::vector<uint8_t>& needle) {
+    Pattern pattern;
+    pattern.needle = needle;
     size_t m = needle.size();
 
-    if (m == 0 || n < m + startOffset) return -1;
-
     // create skip table
-    size_t skip[256];
     for (int i = 0; i < 256; ++i) {
-        skip[i] = m;
+        pattern.skip[i] = m;
     }
 
-    for (size_t i = 0; i < m - 1; ++i) {
-        skip[needle[i]] = m - 1 - i;
+    for (size_t i = 0; m > 0 && i < m - 1; ++i) {
+        pattern.skip[needle[i]] = m - 1 - i;
     }
+    return pattern;
+}
+
+int64_t Searcher::search(const std::vector<uint8_t>& haystack,
+                         const std::vector<uint8_t>& needle,
+                         size_t startOffset) {
+    if (needle.empty() || haystack.size() < needle.size() + startOffset) return -1;
+    return search(haystack, compile(needle), startOffset);
+}
+
+int64_t Searcher::search(const std::vector<uint8_t>& haystack,
+                         const Pattern& pattern,
+                         size_t startOffset) {
+    const std::vector<uint8_t>& needle = pattern.needle;
+    size_t n = haystack.size();
+    size_t m = needle.size();
+
+    if (m == 0 || n < m + startOffset) return -1;
 
     // start searching
     size_t i = startOffset + m - 1;
@@ -32,7 +46,7 @@ int64_t Searcher::search(const std::vector<uint8_t>& haystack,
             return i - m + 1; // Match found
         }
 
-        i += skip[haystack[i]];
+        i += pattern.skip[haystack[i]];
     }
     
     return -1; // No match found
@@ -0,0 +1,15 @@
+#include "signature_matcher.hpp"
+
+SignatureMatcher::SignatureMatcher(const std::vector<FileSignature>& signatures) : signatures_(signatures) {
+    for (const auto& sig : signatures_) {
+        headers_.push_back(Searcher::compile(sig.header));
+        footers_.push_back(Searcher::compile(sig.footer));
+    }
+}
+
+const FileSignature* SignatureMatcher::find(const std::string& extension) const {
+    for (const auto& sig : signatures_) {
+        if (sig.extension == extension) return &sig;
+    }
+    return nullptr;
+}
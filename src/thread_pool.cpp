@@ -0,0 +1,57 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(size_t threads, size_t maxQueued)
+    : maxQueued_(maxQueued == 0 ? 1 : maxQueued) {
+    if (threads == 0) threads = 1;
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    taskReady_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    spaceReady_.wait(lock, [this] { return tasks_.size() < maxQueued_; });
+    tasks_.push_back(std::move(task));
+    lock.unlock();
+    taskReady_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return tasks_.empty() && running_ == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            taskReady_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            // Finish queued work before exiting
+            if (tasks_.empty()) return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+            ++running_;
+        }
+        spaceReady_.notify_one();
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --running_;
+            if (tasks_.empty() && running_ == 0) idle_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,262 @@
+#include "tolerant_source.hpp"
+#include "journal.hpp"
+#include "metrics.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+/* --- BadSectorMap --- */
+
+uint64_t BadSectorMap::add(uint64_t offset, uint64_t length) {
+    if (length == 0) return 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t start = offset;
+    uint64_t end = offset + length;
+    uint64_t known = 0;
+
+    // Absorb every range touching [offset, offset + length)
+    auto it = ranges_.upper_bound(start);
+    if (it != ranges_.begin() && std::prev(it)->second >= start) --it;
+    while (it != ranges_.end() && it->first <= offset + length) {
+        uint64_t from = std::max(offset, it->first);
+        uint64_t to = std::min(offset + length, it->second);
+        if (to > from) known += to - from;
+        start = std::min(start, it->first);
+        end = std::max(end, it->second);
+        it = ranges_.erase(it);
+    }
+    ranges_[start] = end;
+    return length - known;
+}
+
+uint64_t BadSectorMap::overlap(uint64_t offset, uint64_t length) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t end = offset + length;
+    uint64_t total = 0;
+    auto it = ranges_.upper_bound(offset);
+    if (it != ranges_.begin()) --it;
+    for (; it != ranges_.end() && it->first < end; ++it) {
+        uint64_t from = std::max(offset, it->first);
+        uint64_t to = std::min(end, it->second);
+        if (to > from) total += to - from;
+    }
+    return total;
+}
+
+bool BadSectorMap::next(uint64_t offset, Range& range) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ranges_.upper_bound(offset);
+    if (it != ranges_.begin() && std::prev(it)->second > offset) --it;
+    if (it == ranges_.end()) return false;
+    range = Range{it->first, it->second - it->first};
+    return true;
+}
+
+std::vector<BadSectorMap::Range> BadSectorMap::ranges() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Range> out;
+    for (const auto& r : ranges_) out.push_back(Range{r.first, r.second - r.first});
+    return out;
+}
+
+uint64_t BadSectorMap::badBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = 0;
+    for (const auto& r : ranges_) total += r.second - r.first;
+    return total;
+}
+
+bool BadSectorMap::save(const std::string& path) const {
+    std::string data = "# FILEEdo bad sector map: offset length (bytes, hex)\n";
+    char line[64];
+    for (const auto& r : ranges()) {
+        snprintf(line, sizeof(line), "0x%llx 0x%llx\n", static_cast<unsigned long long>(r.offset),
+                 static_cast<unsigned long long>(r.length));
+        data += line;
+    }
+
+    // Same as the journal: temp file + fsync + rename + directory fsync, so a crash never leaves a half-written map
+    std::string tmp = path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+    ok = fsync(fd) == 0 && ok;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    return CarveJournal::syncDirectory(path);
+}
+
+bool BadSectorMap::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        char* end = nullptr;
+        uint64_t offset = std::strtoull(line.c_str(), &end, 0);
+        uint64_t length = std::strtoull(end, nullptr, 0);
+        add(offset, length);
+    }
+    return true;
+}
+
+/* --- TolerantImageSource --- */
+
+TolerantImageSource::TolerantImageSource(std::shared_ptr<ImageSource> inner, uint32_t sectorSize, uint64_t maxSkip)
+    : inner_(std::move(inner)), sectorSize_(sectorSize ? sectorSize : 512) {
+    maxSkip_ = std::max<uint64_t>(sectorSize_, maxSkip - maxSkip % sectorSize_);
+}
+
+ssize_t TolerantImageSource::readAt(uint64_t offset, void* buffer, size_t size) {
+    uint64_t total = inner_->size();
+    if (offset >= total) return 0;
+    uint64_t length = std::min<uint64_t>(size, total - offset);
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+
+    // Fast path: nothing known to be bad and the device delivers everything
+    uint64_t done = 0;
+    if (badSectors_.overlap(offset, length) == 0) {
+        ssize_t n = inner_->readAt(offset, out, length);
+        if (n > 0) done = static_cast<uint64_t>(n);
+        if (done == length) {
+            std::lock_guard<std::mutex> lock(skipMutex_);
+            skip_ = 0;
+            return static_cast<ssize_t>(length);
+        }
+    }
+    readSlow(offset + done, out + done, length - done);
+    return static_cast<ssize_t>(length);
+}
+
+uint64_t TolerantImageSource::readPrefix(uint64_t offset, uint8_t* out, uint64_t length) {
+    ssize_t n = inner_->readAt(offset, out, length);
+    if (n > 0 && static_cast<uint64_t>(n) == length) return length;
+    // A short read inside the image means the device stopped at an error; keep what arrived
+    if (n > 0) {
+        uint64_t got = static_cast<uint64_t>(n);
+        return got + readPrefix(offset + got, out + got, length - got);
+    }
+    if (alignDown(offset) == alignDown(offset + length - 1)) return 0;   // One sector: it is the bad one
+
+    // Bisect on a sector boundary
+    uint64_t mid = alignDown(offset + length / 2);
+    if (mid <= offset) mid = alignDown(offset) + sectorSize_;
+    uint64_t left = readPrefix(offset, out, mid - offset);
+    if (left < mid - offset) return left;
+    return left + readPrefix(mid, out + left, offset + length - mid);
+}
+
+uint64_t TolerantImageSource::readSuffix(uint64_t offset, uint8_t* out, uint64_t length) {
+    ssize_t n = inner_->readAt(offset, out, length);
+    if (n > 0 && static_cast<uint64_t>(n) == length) return length;
+    // A short read stopped at an unreadable sector: the suffix can only start after it
+    if (n > 0) {
+        uint64_t next = alignDown(offset + static_cast<uint64_t>(n)) + sectorSize_;
+        if (next >= offset + length) return 0;
+        return readSuffix(next, out + (next - offset), offset + length - next);
+    }
+    if (alignDown(offset) == alignDown(offset + length - 1)) return 0;
+
+    uint64_t mid = alignDown(offset + length / 2);
+    if (mid <= offset) mid = alignDown(offset) + sectorSize_;
+    uint64_t right = readSuffix(mid, out + (mid - offset), offset + length - mid);
+    if (right < offset + length - mid) return right;
+    return right + readSuffix(offset, out, mid - offset);
+}
+
+void TolerantImageSource::markBad(uint64_t from, uint64_t to) {
+    to = std::min(inner_->size(), alignDown(to + sectorSize_ - 1));
+    if (to > from) Metrics::add(Counter::BadBytes, badSectors_.add(from, to - from));
+}
+
+void TolerantImageSource::readSlow(uint64_t offset, uint8_t* out, uint64_t length) {
+    const uint64_t end = offset + length;
+    uint64_t pos = offset;
+
+    // Skip distance reached inside a damaged area. A read only inherits it when it continues exactly where
+    // the previous one stopped in the damage, on a sector boundary; any other read starts with a bisection.
+    uint64_t step = 0;
+    {
+        std::lock_guard<std::mutex> lock(skipMutex_);
+        if (skip_ != 0 && offset == skipEnd_ && offset % sectorSize_ == 0) step = skip_;
+    }
+
+    while (pos < end) {
+        // Known bad ranges are zero-filled and never touched again
+        BadSectorMap::Range bad;
+        bool haveBad = badSectors_.next(pos, bad);
+        if (haveBad && bad.offset <= pos) {
+            uint64_t to = std::min(end, bad.offset + bad.length);
+            memset(out + (pos - offset), 0, to - pos);
+            pos = to;
+            continue;
+        }
+        uint64_t limit = (haveBad && bad.offset < end) ? bad.offset : end;
+
+        // Damaged area: [badStart, lastBad + sector) is given up, probe is the next sector to try.
+        // Every probe and trim lies in [pos, limit), so nothing is written outside the caller's buffer.
+        uint64_t badStart;
+        uint64_t lastBad;
+        uint64_t probe;
+        if (step == 0 || pos % sectorSize_ != 0) {
+            // Bisect from pos; this also covers an unaligned head
+            pos += readPrefix(pos, out + (pos - offset), limit - pos);
+            if (pos == limit) continue;
+            badStart = alignDown(pos);
+            lastBad = badStart;
+            step = sectorSize_;
+            probe = badStart + step;
+        } else {
+            // Still inside the damaged area: probe before paying for a bisection
+            badStart = pos;
+            lastBad = UINT64_MAX;
+            probe = pos;
+        }
+
+        // Jump ahead, doubling the distance after every unreadable probe
+        uint64_t landing = limit;
+        while (probe < limit) {
+            uint64_t probeEnd = std::min(limit, probe + sectorSize_);
+            ssize_t n = inner_->readAt(probe, out + (probe - offset), probeEnd - probe);
+            if (n > 0 && static_cast<uint64_t>(n) == probeEnd - probe) {
+                landing = probe;
+                break;
+            }
+            lastBad = probe;
+            step = std::min(step * 2, maxSkip_);
+            probe = alignDown(probe + step);
+        }
+
+        // Trim back from a readable landing sector to recover the good tail of the skipped range
+        uint64_t badEnd = landing;
+        uint64_t trimFrom = lastBad == UINT64_MAX ? badStart : lastBad + sectorSize_;
+        if (landing < limit && landing > trimFrom) {
+            badEnd = landing - readSuffix(trimFrom, out + (trimFrom - offset), landing - trimFrom);
+        }
+        if (lastBad == UINT64_MAX && badEnd == badStart) {
+            // The first probe was readable: the damaged area is over
+            step = 0;
+            pos = std::min(limit, badStart + sectorSize_);
+            continue;
+        }
+
+        markBad(badStart, badEnd);
+        uint64_t fillEnd = std::min(end, std::max(pos, std::min(badEnd, limit)));
+        if (fillEnd > pos) memset(out + (pos - offset), 0, fillEnd - pos);
+        pos = std::max(pos, fillEnd);
+        if (landing < limit) step = 0;
+    }
+
+    // Ended inside a damaged area: let the next sequential read continue the skip
+    std::lock_guard<std::mutex> lock(skipMutex_);
+    skip_ = step;
+    skipEnd_ = end;
+}
@@ -0,0 +1,121 @@
+#include "validation_stage.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "validator.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+ValidationStage::ValidationStage(ValidationMode mode, int minScore, size_t threads,
+                                 std::shared_ptr<ImageSource> image, const GapCarveOptions& gapOptions,
+                                 std::shared_ptr<ThreadPool> pool)
+    // Keep the queue short so at most a few whole files are buffered per worker
+    : mode_(mode), minScore_(minScore),
+      pool_(pool ? std::move(pool) : std::make_shared<ThreadPool>(threads, threads * 2)),
+      gapCarver_(std::move(image), gapOptions) {}
+
+void ValidationStage::submit(const std::string& path, const FileSignature& sig, uint64_t headerOffset) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pending_[path] = SinkPendingItem{path, sig.extension, headerOffset};
+        inFlight_++;
+    }
+    pool_->submit([this, path, sig, headerOffset] {
+        validateFile(path, sig, headerOffset);
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        pending_.erase(path);
+        if (--inFlight_ == 0) idle_.notify_all();
+    });
+}
+
+std::vector<SinkPendingItem> ValidationStage::pending() {
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    std::vector<SinkPendingItem> result;
+    for (const auto& entry : pending_) result.push_back(entry.second);
+    return result;
+}
+
+void ValidationStage::drain() {
+    // The pool may be shared, so wait for this stage's tasks only
+    {
+        std::unique_lock<std::mutex> lock(pendingMutex_);
+        idle_.wait(lock, [this] { return inFlight_ == 0; });
+    }
+    std::cout << "[*] Validation: " << accepted_.load() << " accepted (" << reassembled_.load()
+              << " reassembled), " << rejected_.load() << " rejected" << std::endl;
+}
+
+bool ValidationStage::writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    size_t total = 0;
+    while (total < data.size()) {
+        ssize_t n = write(fd, data.data() + total, data.size() - total);
+        if (n <= 0) break;
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+    return total == data.size();
+}
+
+void ValidationStage::validateFile(const std::string& path, const FileSignature& sig, uint64_t headerOffset) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return;
+    }
+
+    std::vector<uint8_t> data(static_cast<size_t>(st.st_size));
+    size_t total = 0;
+    while (total < data.size()) {
+        ssize_t n = read(fd, data.data() + total, data.size() - total);
+        if (n <= 0) break;
+        total += static_cast<size_t>(n);
+    }
+    close(fd);
+    data.resize(total);
+
+    ValidationResult result = Validator::validate(sig.extension, data.data(), data.size());
+    if (result.score >= minScore_) {
+        accepted_++;
+        Metrics::add(Counter::Accepted);
+        return;
+    }
+
+    // Fragmented file? Try to skip a cluster-aligned gap after the first error
+    if (GapCarver::supports(sig.extension)) {
+        GapCarveResult gap = gapCarver_.carve(sig, headerOffset, result.validBytes, minScore_);
+        if (gap.found && writeFile(path, gap.data)) {
+            accepted_++;
+            reassembled_++;
+            Metrics::add(Counter::Accepted);
+            Metrics::add(Counter::Reassembled);
+            if (!Logger::enabled(LogLevel::Info)) return;
+            std::lock_guard<std::mutex> lock(logMutex_);
+            std::cout << " [Reassembled] " << path << " (split at " << gap.splitOffset << ", gap "
+                      << gap.gapSize << " bytes, score " << gap.score << ")\n";
+            return;
+        }
+    }
+    rejected_++;
+    Metrics::add(Counter::Rejected);
+
+    if (mode_ == ValidationMode::Discard) {
+        unlink(path.c_str());
+    } else if (mode_ == ValidationMode::Tag) {
+        std::string tagged = path + ".invalid";
+        rename(path.c_str(), tagged.c_str());
+    }
+
+    if (!Logger::enabled(LogLevel::Info)) return;
+    std::lock_guard<std::mutex> lock(logMutex_);
+    std::cout << " [Rejected] " << path << " (score " << result.score << ": " << result.reason
+              << " at byte " << result.validBytes << ")\n";
+}
@@ -0,0 +1,539 @@
+#include "validator.hpp"
+#include "checksum.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/* --- Helper --- */
+
+namespace {
+
+uint16_t readBE16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t readBE32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+ValidationResult makeResult(int score, size_t validBytes, const std::string& reason) {
+    ValidationResult result;
+    result.score = score;
+    result.validBytes = validBytes;
+    result.reason = reason;
+    return result;
+}
+
+/* --- JPEG --- */
+
+// Canonical Huffman table (ITU T.81 Annex C / F.2.2.3)
+struct HuffTable {
+    bool defined = false;
+    uint8_t symbols[256] = {};
+    int32_t minCode[17] = {};
+    int32_t maxCode[18] = {};
+    int32_t valPtr[17] = {};
+};
+
+// Build decoding tables; returns false for over-subscribed code lengths
+bool buildHuffTable(HuffTable& table, const uint8_t* counts, const uint8_t* symbols, size_t total) {
+    int32_t code = 0;
+    int32_t k = 0;
+    for (int len = 1; len <= 16; ++len) {
+        int32_t count = counts[len - 1];
+        if (count == 0) {
+            table.maxCode[len] = -1;
+        } else {
+            table.valPtr[len] = k;
+            table.minCode[len] = code;
+            code += count;
+            k += count;
+            table.maxCode[len] = code - 1;
+        }
+        if (code > (1 << len)) return false;
+        code <<= 1;
+    }
+    table.maxCode[17] = 0x7FFFFFFF;
+    std::memcpy(table.symbols, symbols, total);
+    table.defined = true;
+    return true;
+}
+
+// Bit reader over entropy-coded data; stops at the first marker
+class JpegBitReader {
+public:
+    JpegBitReader(const uint8_t* data, size_t size, size_t pos) : data_(data), size_(size), pos_(pos) {}
+
+    // Returns -1 once the reader would have to read past a marker or the end of data
+    int bit() {
+        if (bits_ == 0 && !fill()) return -1;
+        --bits_;
+        return (acc_ >> bits_) & 1;
+    }
+
+    int receive(int count, int32_t& value) {
+        value = 0;
+        for (int i = 0; i < count; ++i) {
+            int b = bit();
+            if (b < 0) return -1;
+            value = (value << 1) | b;
+        }
+        return 0;
+    }
+
+    int decode(const HuffTable& table) {
+        int b = bit();
+        if (b < 0) return -1;
+        int32_t code = b;
+        int len = 1;
+        while (code > table.maxCode[len]) {
+            if (++len > 16) return -2; // Not a valid code in this table
+            b = bit();
+            if (b < 0) return -1;
+            code = (code << 1) | b;
+        }
+        return table.symbols[table.valPtr[len] + code - table.minCode[len]];
+    }
+
+    // Drop buffered bits and step over an expected RSTn marker
+    bool restart(int index) {
+        bits_ = 0;
+        markerHit_ = false;
+        if (pos_ + 1 >= size_) return false;
+        if (data_[pos_] != 0xFF || data_[pos_ + 1] != 0xD0 + (index & 7)) return false;
+        pos_ += 2;
+        return true;
+    }
+
+    size_t position() const { return pos_; }
+    bool truncated() const { return pos_ >= size_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+    uint32_t acc_ = 0;
+    int bits_ = 0;
+    bool markerHit_ = false;
+
+    bool fill() {
+        if (markerHit_ || pos_ >= size_) return false;
+        uint8_t b = data_[pos_];
+        if (b == 0xFF) {
+            if (pos_ + 1 >= size_) { pos_ = size_; return false; }
+            if (data_[pos_ + 1] != 0x00) { markerHit_ = true; return false; }
+            pos_ += 2;
+        } else {
+            pos_ += 1;
+        }
+        acc_ = (acc_ << 8) | b;
+        bits_ = 8;
+        return true;
+    }
+};
+
+struct JpegComponent {
+    uint8_t id = 0;
+    uint8_t h = 1;
+    uint8_t v = 1;
+    uint8_t dcTable = 0;
+    uint8_t acTable = 0;
+    uint8_t quantTable = 0;
+};
+
+struct JpegFrame {
+    bool present = false;
+    bool huffmanBaseline = false;   // SOF0/SOF1: scans can be Huffman decoded
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint8_t hMax = 1;
+    uint8_t vMax = 1;
+    std::vector<JpegComponent> components;
+};
+
+// Decode one baseline block; returns false on an invalid code or data underflow
+bool decodeBlock(JpegBitReader& reader, const HuffTable& dc, const HuffTable& ac) {
+    int s = reader.decode(dc);
+    if (s < 0 || s > 11) return false;
+    int32_t value;
+    if (reader.receive(s, value) < 0) return false;
+
+    for (int k = 1; k < 64; ) {
+        int rs = reader.decode(ac);
+        if (rs < 0) return false;
+        int r = rs >> 4;
+        int size = rs & 0x0F;
+        if (size == 0) {
+            if (r != 15) break; // EOB
+            k += 16;
+            continue;
+        }
+        k += r;
+        if (k > 63 || size > 10) return false;
+        if (reader.receive(size, value) < 0) return false;
+        ++k;
+    }
+    return true;
+}
+
+// Find the next marker after a non-decodable entropy segment; returns the offset of its 0xFF
+size_t skipEntropyData(const uint8_t* data, size_t size, size_t pos) {
+    while (pos + 1 < size) {
+        if (data[pos] == 0xFF) {
+            uint8_t next = data[pos + 1];
+            if (next == 0x00 || (next >= 0xD0 && next <= 0xD7)) { pos += 2; continue; }
+            if (next == 0xFF) { pos += 1; continue; }
+            return pos;
+        }
+        ++pos;
+    }
+    return size;
+}
+
+} // namespace
+
+/* --- Method of Validator --- */
+
+ValidationResult Validator::validate(const std::string& extension, const uint8_t* data, size_t size) {
+    if (extension == "jpg") return validateJpeg(data, size);
+    if (extension == "png") return validatePng(data, size);
+    if (extension == "pdf") return validatePdf(data, size);
+    return makeResult(100, size, "");
+}
+
+ValidationResult Validator::validateJpeg(const uint8_t* data, size_t size) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) return makeResult(0, 0, "missing SOI");
+
+    HuffTable dcTables[4];
+    HuffTable acTables[4];
+    bool quantDefined[4] = {false, false, false, false};
+    JpegFrame frame;
+    uint16_t restartInterval = 0;
+    bool sawScan = false;
+    bool decodedScan = false;
+    size_t pos = 2;
+
+    while (pos < size) {
+        size_t markerPos = pos;
+        if (data[pos] != 0xFF) return makeResult(10, markerPos, "expected marker");
+        while (pos < size && data[pos] == 0xFF) ++pos; // Fill bytes
+        if (pos >= size) break;
+        uint8_t marker = data[pos++];
+
+        if (marker == 0xD9) {
+            if (!sawScan) return makeResult(20, markerPos, "EOI before any scan");
+            if (!frame.huffmanBaseline || !decodedScan) return makeResult(80, size, "");
+            return makeResult(100, size, "");
+        }
+        if ((marker >= 0xD0 && marker <= 0xD7) || marker == 0x01) continue;
+        if (marker == 0x00 || marker == 0xD8) return makeResult(10, markerPos, "invalid marker");
+
+        if (pos + 2 > size) break;
+        uint16_t length = readBE16(data + pos);
+        if (length < 2) return makeResult(10, markerPos, "bad segment length");
+        if (pos + length > size) break;
+        const uint8_t* seg = data + pos + 2;
+        size_t segLen = length - 2;
+        size_t segEnd = pos + length;
+
+        switch (marker) {
+        case 0xDB: { // DQT
+            size_t i = 0;
+            while (i < segLen) {
+                uint8_t pq = seg[i] >> 4;
+                uint8_t tq = seg[i] & 0x0F;
+                size_t tableLen = 1 + (pq ? 128 : 64);
+                if (pq > 1 || tq > 3 || i + tableLen > segLen) return makeResult(10, markerPos, "bad DQT");
+                quantDefined[tq] = true;
+                i += tableLen;
+            }
+            break;
+        }
+        case 0xC4: { // DHT
+            size_t i = 0;
+            while (i < segLen) {
+                if (i + 17 > segLen) return makeResult(10, markerPos, "bad DHT");
+                uint8_t tc = seg[i] >> 4;
+                uint8_t th = seg[i] & 0x0F;
+                if (tc > 1 || th > 3) return makeResult(10, markerPos, "bad DHT class/id");
+                size_t total = 0;
+                for (int k = 0; k < 16; ++k) total += seg[i + 1 + k];
+                if (total > 256 || i + 17 + total > segLen) return makeResult(10, markerPos, "bad DHT counts");
+                HuffTable& table = tc == 0 ? dcTables[th] : acTables[th];
+                if (!buildHuffTable(table, seg + i + 1, seg + i + 17, total)) {
+                    return makeResult(10, markerPos, "over-subscribed Huffman table");
+                }
+                i += 17 + total;
+            }
+            break;
+        }
+        case 0xC0: case 0xC1: case 0xC2: case 0xC3:
+        case 0xC5: case 0xC6: case 0xC7:
+        case 0xC9: case 0xCA: case 0xCB:
+        case 0xCD: case 0xCE: case 0xCF: { // SOFn
+            if (frame.present) return makeResult(10, markerPos, "duplicate SOF");
+            if (segLen < 6) return makeResult(10, markerPos, "bad SOF");
+            uint8_t precision = seg[0];
+            frame.height = readBE16(seg + 1);
+            frame.width = readBE16(seg + 3);
+            uint8_t count = seg[5];
+            if (precision == 0 || precision > 16 || frame.width == 0 || count == 0 || count > 4 ||
+                segLen < 6 + count * 3u) {
+                return makeResult(10, markerPos, "bad SOF");
+            }
+            for (uint8_t c = 0; c < count; ++c) {
+                JpegComponent comp;
+                comp.id = seg[6 + c * 3];
+                comp.h = seg[7 + c * 3] >> 4;
+                comp.v = seg[7 + c * 3] & 0x0F;
+                comp.quantTable = seg[8 + c * 3];
+                if (comp.h == 0 || comp.h > 4 || comp.v == 0 || comp.v > 4 || comp.quantTable > 3) {
+                    return makeResult(10, markerPos, "bad SOF component");
+                }
+                frame.hMax = std::max(frame.hMax, comp.h);
+                frame.vMax = std::max(frame.vMax, comp.v);
+                frame.components.push_back(comp);
+            }
+            frame.present = true;
+            // Height 0 defers to a DNL marker; decode only when the geometry is known
+            frame.huffmanBaseline = (marker == 0xC0 || marker == 0xC1) && frame.height != 0;
+            break;
+        }
+        case 0xDD: // DRI
+            if (segLen < 2) return makeResult(10, markerPos, "bad DRI");
+            restartInterval = readBE16(seg);
+            break;
+        case 0xDA: { // SOS
+            if (!frame.present) return makeResult(20, markerPos, "SOS before SOF");
+            if (segLen < 1) return makeResult(10, markerPos, "bad SOS");
+            uint8_t count = seg[0];
+            if (count == 0 || count > 4 || segLen < 4 + count * 2u) return makeResult(10, markerPos, "bad SOS");
+
+            std::vector<JpegComponent> scanComps;
+            for (uint8_t c = 0; c < count; ++c) {
+                uint8_t id = seg[1 + c * 2];
+                auto it = std::find_if(frame.components.begin(), frame.components.end(),
+                                       [id](const JpegComponent& comp) { return comp.id == id; });
+                if (it == frame.components.end()) return makeResult(10, markerPos, "SOS references unknown component");
+                if (!quantDefined[it->quantTable]) return makeResult(20, markerPos, "missing DQT");
+                JpegComponent comp = *it;
+                comp.dcTable = seg[2 + c * 2] >> 4;
+                comp.acTable = seg[2 + c * 2] & 0x0F;
+                if (comp.dcTable > 3 || comp.acTable > 3) return makeResult(10, markerPos, "bad SOS table id");
+                scanComps.push_back(comp);
+            }
+            sawScan = true;
+
+            bool tablesReady = true;
+            for (const auto& comp : scanComps) {
+                if (!dcTables[comp.dcTable].defined || !acTables[comp.acTable].defined) tablesReady = false;
+            }
+            if (!frame.huffmanBaseline || !tablesReady) {
+                if (frame.huffmanBaseline) return makeResult(20, markerPos, "scan uses undefined Huffman table");
+                pos = skipEntropyData(data, size, segEnd);
+                continue;
+            }
+
+            // Work out the MCU layout of this scan
+            uint32_t mcusX, mcusY;
+            if (count == 1) {
+                const JpegComponent& comp = scanComps[0];
+                uint32_t compW = (static_cast<uint32_t>(frame.width) * comp.h + frame.hMax - 1) / frame.hMax;
+                uint32_t compH = (static_cast<uint32_t>(frame.height) * comp.v + frame.vMax - 1) / frame.vMax;
+                mcusX = (compW + 7) / 8;
+                mcusY = (compH + 7) / 8;
+                scanComps[0].h = 1;
+                scanComps[0].v = 1;
+            } else {
+                mcusX = (frame.width + 8u * frame.hMax - 1) / (8u * frame.hMax);
+                mcusY = (frame.height + 8u * frame.vMax - 1) / (8u * frame.vMax);
+            }
+            uint64_t totalMcus = static_cast<uint64_t>(mcusX) * mcusY;
+
+            JpegBitReader reader(data, size, segEnd);
+            int restartIndex = 0;
+            for (uint64_t mcu = 0; mcu < totalMcus; ++mcu) {
+                if (restartInterval != 0 && mcu != 0 && mcu % restartInterval == 0) {
+                    if (!reader.restart(restartIndex++)) {
+                        if (reader.truncated()) return makeResult(40, size, "truncated in scan");
+                        return makeResult(30, reader.position(), "restart marker out of sequence");
+                    }
+                }
+                for (const auto& comp : scanComps) {
+                    for (int b = 0; b < comp.h * comp.v; ++b) {
+                        if (!decodeBlock(reader, dcTables[comp.dcTable], acTables[comp.acTable])) {
+                            if (reader.truncated()) return makeResult(40, size, "truncated in scan");
+                            return makeResult(30, reader.position(), "Huffman decode error");
+                        }
+                    }
+                }
+            }
+            decodedScan = true;
+
+            // Only padding may sit between the last MCU and the next marker
+            size_t next = skipEntropyData(data, size, reader.position());
+            if (next - reader.position() > 16) return makeResult(30, reader.position(), "junk after scan data");
+            pos = next;
+            continue;
+        }
+        default: // APPn, COM, DNL, ...
+            break;
+        }
+        pos = segEnd;
+    }
+
+    if (!frame.present || !sawScan) return makeResult(20, size, "truncated before image data");
+    return makeResult(40, size, "missing EOI");
+}
+
+ValidationResult Validator::validatePng(const uint8_t* data, size_t size) {
+    static const uint8_t PNG_SIGNATURE[8] = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
+    if (size < 8 || std::memcmp(data, PNG_SIGNATURE, 8) != 0) return makeResult(0, 0, "missing PNG signature");
+
+    size_t pos = 8;
+    bool sawHeader = false;
+    bool sawData = false;
+
+    while (pos + 12 <= size) {
+        uint32_t length = readBE32(data + pos);
+        const uint8_t* type = data + pos + 4;
+        if (length > 0x7FFFFFFFu) return makeResult(10, pos, "bad chunk length");
+        for (int i = 0; i < 4; ++i) {
+            bool letter = (type[i] >= 'A' && type[i] <= 'Z') || (type[i] >= 'a' && type[i] <= 'z');
+            if (!letter) return makeResult(10, pos, "bad chunk type");
+        }
+        if (pos + 12 + length > size) return makeResult(40, pos, "truncated chunk");
+
+        uint32_t stored = readBE32(data + pos + 8 + length);
+        if (Checksum::crc32(type, 4 + length) != stored) return makeResult(30, pos, "chunk CRC mismatch");
+
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            if (pos != 8 || length != 13) return makeResult(10, pos, "bad IHDR");
+            const uint8_t* ihdr = data + pos + 8;
+            uint8_t bitDepth = ihdr[8];
+            uint8_t colorType = ihdr[9];
+            if (readBE32(ihdr) == 0 || readBE32(ihdr + 4) == 0 || bitDepth == 0 || bitDepth > 16 ||
+                colorType > 6 || colorType == 1 || colorType == 5) {
+                return makeResult(10, pos, "bad IHDR");
+            }
+            sawHeader = true;
+        } else if (!sawHeader) {
+            return makeResult(10, pos, "first chunk is not IHDR");
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            sawData = true;
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            if (!sawData) return makeResult(20, pos, "no IDAT chunk");
+            return makeResult(100, size, "");
+        }
+        pos += 12 + length;
+    }
+
+    return makeResult(40, pos, "missing IEND");
+}
+
+ValidationResult Validator::validatePdf(const uint8_t* data, size_t size) {
+    if (size < 8 || std::memcmp(data, "%PDF-", 5) != 0 || data[5] < '1' || data[5] > '9') {
+        return makeResult(0, 0, "missing PDF header");
+    }
+
+    // Skip trailing EOLs after the final %%EOF
+    size_t end = size;
+    while (end > 0 && (data[end - 1] == '\n' || data[end - 1] == '\r' || data[end - 1] == ' ')) --end;
+    if (end < 5 || std::memcmp(data + end - 5, "%%EOF", 5) != 0) return makeResult(40, size, "missing %%EOF");
+
+    // Locate the last startxref in the tail
+    size_t tailStart = end > 1024 ? end - 1024 : 0;
+    const uint8_t* startxref = nullptr;
+    for (const uint8_t* p = data + tailStart;
+         (p = static_cast<const uint8_t*>(memmem(p, data + end - p, "startxref", 9))) != nullptr; p += 9) {
+        startxref = p;
+    }
+
+    auto countObjects = [&]() {
+        size_t objects = 0;
+        const uint8_t* p = data;
+        while ((p = static_cast<const uint8_t*>(memmem(p, data + size - p, "endobj", 6))) != nullptr) {
+            ++objects;
+            p += 6;
+        }
+        return objects;
+    };
+
+    if (!startxref) {
+        return countObjects() > 0 ? makeResult(40, size, "no startxref") : makeResult(10, 0, "no objects");
+    }
+
+    const uint8_t* p = startxref + 9;
+    while (p < data + end && (*p == ' ' || *p == '\r' || *p == '\n')) ++p;
+    uint64_t xrefOffset = 0;
+    bool haveDigits = false;
+    while (p < data + end && *p >= '0' && *p <= '9') {
+        xrefOffset = xrefOffset * 10 + (*p++ - '0');
+        haveDigits = true;
+        if (xrefOffset > size) break;
+    }
+    if (!haveDigits || xrefOffset >= size) {
+        return makeResult(30, std::min<uint64_t>(xrefOffset, size), "startxref points outside file");
+    }
+
+    // Cross-reference stream (PDF 1.5+): only the object header can be checked cheaply
+    if (std::memcmp(data + xrefOffset, "xref", std::min<size_t>(4, size - xrefOffset)) != 0 ||
+        size - xrefOffset < 4) {
+        const uint8_t* obj = data + xrefOffset;
+        const uint8_t* limit = data + std::min<size_t>(size, xrefOffset + 32);
+        if (memmem(obj, limit - obj, " obj", 4) != nullptr) return makeResult(80, size, "");
+        return makeResult(30, xrefOffset, "startxref does not point at xref");
+    }
+
+    // Classic xref table: "start count" subsections of 20-byte entries
+    struct XrefEntry {
+        uint64_t objNum;
+        uint64_t offset;
+    };
+    std::vector<XrefEntry> entries;
+
+    auto skipSpace = [&](size_t& i) {
+        while (i < size && (data[i] == ' ' || data[i] == '\r' || data[i] == '\n')) ++i;
+    };
+    auto readNumber = [&](size_t& i, uint64_t& value) {
+        value = 0;
+        size_t start = i;
+        while (i < size && data[i] >= '0' && data[i] <= '9' && i - start < 19) value = value * 10 + (data[i++] - '0');
+        return i > start;
+    };
+
+    size_t i = xrefOffset + 4;
+    while (true) {
+        skipSpace(i);
+        uint64_t first, count;
+        if (!readNumber(i, first)) break; // "trailer" or junk
+        skipSpace(i);
+        if (!readNumber(i, count)) return makeResult(30, xrefOffset, "bad xref subsection");
+        skipSpace(i);
+        for (uint64_t e = 0; e < count; ++e) {
+            if (i + 18 > size) return makeResult(30, xrefOffset, "truncated xref table");
+            uint64_t offset = 0;
+            for (int d = 0; d < 10; ++d) offset = offset * 10 + (data[i + d] - '0');
+            if (data[i + 17] == 'n' && offset != 0) entries.push_back({first + e, offset});
+            i += 20;
+        }
+    }
+    if (entries.empty()) return makeResult(30, xrefOffset, "empty xref table");
+
+    // Every in-use entry must land on "<objNum> <gen> obj"; the earliest miss bounds the valid prefix
+    std::sort(entries.begin(), entries.end(),
+              [](const XrefEntry& a, const XrefEntry& b) { return a.offset < b.offset; });
+    for (const auto& entry : entries) {
+        size_t at = entry.offset;
+        uint64_t objNum;
+        bool ok = at < size && readNumber(at, objNum) && objNum == entry.objNum;
+        if (ok) {
+            const uint8_t* limit = data + std::min<size_t>(size, at + 16);
+            ok = memmem(data + at, limit - (data + at), "obj", 3) != nullptr;
+        }
+        if (!ok) return makeResult(30, entry.offset, "xref entry does not point at its object");
+    }
+
+    return makeResult(100, size, "");
+}